@@ -0,0 +1,149 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* How long to wait for the server to start listening */
+#define CONNECT_RETRY_MS 5000
+
+/* The request sent by every client, it computes a sum of squares and emits a
+ * single character */
+static char Request[] =
+    ": sq dup * ; "
+    ": sum-squares 0 100 begin swap over sq + swap 1 - dup 0 = until drop ; "
+    "sum-squares 338350 = 48 + emit";
+
+/** A client thread and the latency of each of its requests */
+typedef struct {
+    pthread_t thread;
+    long requests;
+    double* latency_ns;
+    long failures;
+} client_t;
+
+static char const* Socket_Path = NULL;
+static char const* Exec_Command = NULL;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+static int connect_server(void) {
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, Socket_Path, sizeof(addr.sun_path) - 1);
+    if ((fd >= 0) && connect(fd, (struct sockaddr*)&addr, sizeof(addr))) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/* Send the request and read the response until the server closes the
+ * connection, returning non-zero if the expected output was not received */
+static int request_socket(void) {
+    char buf[256];
+    size_t len = 0;
+    ssize_t count;
+    int fd = connect_server();
+    if (fd < 0)
+        return 1;
+    if ((write(fd, Request, sizeof(Request) - 1) != (ssize_t)(sizeof(Request) - 1)) ||
+        shutdown(fd, SHUT_WR)) {
+        close(fd);
+        return 1;
+    }
+    while ((count = read(fd, buf + len, sizeof(buf) - len - 1)) > 0)
+        len += (size_t)count;
+    close(fd);
+    buf[len] = '\0';
+    return strcmp(buf, "1");
+}
+
+/* Run the request in a new process that loads the dictionary each time */
+static int request_exec(void) {
+    FILE* proc = popen(Exec_Command, "w");
+    if (!proc)
+        return 1;
+    fwrite(Request, 1u, sizeof(Request) - 1, proc);
+    return (0 != pclose(proc));
+}
+
+static void* client_run(void* arg) {
+    client_t* client = (client_t*)arg;
+    long i;
+    for (i = 0; i < client->requests; i++) {
+        double start = now_ns();
+        if (Exec_Command ? request_exec() : request_socket())
+            client->failures++;
+        client->latency_ns[i] = now_ns() - start;
+    }
+    return NULL;
+}
+
+static int compare_double(void const* lval, void const* rval) {
+    double l = *(double const*)lval, r = *(double const*)rval;
+    return (l > r) - (l < r);
+}
+
+static void run_load(char* name, long clients, long requests) {
+    client_t* client = (client_t*)calloc((size_t)clients, sizeof(client_t));
+    double* latency  = (double*)malloc((size_t)(clients * requests) * sizeof(double));
+    long failures = 0, total = clients * requests, i;
+    double start = now_ns();
+    for (i = 0; i < clients; i++) {
+        client[i].requests   = requests;
+        client[i].latency_ns = latency + (i * requests);
+        pthread_create(&client[i].thread, NULL, client_run, &client[i]);
+    }
+    for (i = 0; i < clients; i++) {
+        pthread_join(client[i].thread, NULL);
+        failures += client[i].failures;
+    }
+    start = now_ns() - start;
+    qsort(latency, (size_t)total, sizeof(double), compare_double);
+    printf("%s\t%ld\t%ld\t%.0f\t%.1f\t%.1f\t%ld\n", name, clients, total,
+           (double)total * 1e9 / start, latency[total / 2] / 1e3,
+           latency[(total * 99) / 100] / 1e3, failures);
+    free(latency);
+    free(client);
+}
+
+int main(int argc, char** argv) {
+    struct timespec delay = { 0, 10000000 };
+    long requests = 2000, waited;
+    int fd;
+    if ((argc == 3) && !strcmp(argv[1], "--exec")) {
+        Exec_Command = argv[2];
+        requests = 20;
+    } else if (argc == 2) {
+        Socket_Path = argv[1];
+    } else {
+        fprintf(stderr, "usage: %s SOCKET | --exec COMMAND\n", argv[0]);
+        return 1;
+    }
+    /* Wait for the server to start listening */
+    for (waited = 0; Socket_Path && ((fd = connect_server()) < 0); waited += 10) {
+        if (waited >= CONNECT_RETRY_MS) {
+            fprintf(stderr, "%s: unable to connect\n", Socket_Path);
+            return 1;
+        }
+        nanosleep(&delay, NULL);
+    }
+    if (Socket_Path)
+        close(fd);
+    puts("workload\tclients\trequests\trequests_per_sec\tp50_us\tp99_us\tfailures");
+    run_load(Exec_Command ? "exec-1" : "server-1", 1, requests);
+    run_load(Exec_Command ? "exec-4" : "server-4", 4, requests / 4);
+    run_load(Exec_Command ? "exec-16" : "server-16", 16, requests / 16);
+    return 0;
+}
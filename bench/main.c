@@ -0,0 +1,627 @@
+/* The workloads are all loaded into one dictionary so it is larger than the
+ * default */
+#define WORD_BUF_SZ (2048 * sizeof(value_t))
+
+#include "onward.h"
+#include "onward_sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+/* The number of times each workload is repeated, the fastest run is reported */
+#define BENCH_REPEAT 5
+
+/** A named workload executed repeatedly by the benchmark harness */
+typedef struct {
+    /** Name of the workload as it appears in the report */
+    char* name;
+    /** Forth source that defines the words used by the workload */
+    char* setup;
+    /** The word executed once per iteration of the workload */
+    char* word;
+    /** The number of iterations to execute per run */
+    long iters;
+} workload_t;
+
+static workload_t Workloads[] = {
+    { "dict-lookup",
+      "s\" VERSION\" 1 cells allot drop const vname "
+      ": lookup-stress 100 begin vname find drop 1 - dup 0 = until drop ; ",
+      "lookup-stress", 2000 },
+    { "arith-loop",
+      ": arith-loop 0 1000 begin swap over + 3 * 7 % swap 1 - dup 0 = until drop drop ; ",
+      "arith-loop", 2000 },
+    { "recursion",
+      ": fib dup 2 < if else dup 1 - recurse swap 2 - recurse + then ; "
+      ": fib-15 15 fib drop ; ",
+      "fib-15", 500 },
+    { "string",
+      "s\" the quick brown fox jumps over the lazy dog\" 1 cells allot drop const text "
+      ": slen 0 begin over over + b@ while 1 + repeat nip ; "
+      ": strings 100 begin text slen drop 1 - dup 0 = until drop ; ",
+      "strings", 500 },
+    { "task-switch",
+      ": spinner begin pause again ; "
+      ": start-spinner ' spinner 16 spawn drop ; start-spinner "
+      ": switches 1000 begin pause 1 - dup 0 = until drop ; ",
+      "switches", 500 },
+    { "catch",
+      ": catch-nop 1 + ; "
+      ": catches 0 1000 begin swap ' catch-nop catch drop swap 1 - dup 0 = until drop drop ; ",
+      "catches", 500 },
+    { "linear-search",
+      "variable keys keys 64 cells allot ! "
+      ": fill-keys 0 begin dup cells keys @ + over 7 * ! 1 + dup 64 = until drop ; fill-keys "
+      ": lsearch 0 begin over over cells keys @ + @ <> while 1 + repeat nip ; "
+      ": linear-lookups 0 100 begin swap over 63 & 7 * lsearch + swap 1 - dup 0 = until drop drop ; ",
+      "linear-lookups", 500 },
+    { "table-lookup",
+      "variable tbl tbl 64 table ! "
+      ": fill-table 0 begin dup dup 7 * tbl @ table! 1 + dup 64 = until drop ; fill-table "
+      ": table-lookups 0 100 begin swap over 63 & 7 * tbl @ table@ drop + swap 1 - dup 0 = until drop drop ; ",
+      "table-lookups", 500 },
+    { "umul-native",
+      ": umul-native 100 begin 3037000499123 1234567890123 um* drop drop 1 - dup 0 = until drop ; ",
+      "umul-native", 2000 },
+    /* Double-cell products emulated with 31-bit digits and a base 2^62 result */
+    { "umul-emulated",
+      "variable ea variable eb variable ec variable elo variable ehi variable eq "
+      ": d31 2147483648 ; "
+      ": d62 4611686018427387904 ; "
+      ": emu-um* eb swap ! ea swap ! "
+      "  ea @ d31 % eb @ d31 % * "
+      "  ea @ d31 % eb @ d31 / * ea @ d31 / eb @ d31 % * + "
+      "  dup d31 % d31 * -rot + dup d62 / swap d62 % elo swap ! "
+      "  swap d31 / + ea @ d31 / eb @ d31 / * + ehi swap ! ; "
+      ": umul-emulated 100 begin 3037000499123 1234567890123 emu-um* 1 - dup 0 = until drop ; ",
+      "umul-emulated", 2000 },
+    { "muldiv-native",
+      ": muldiv-native 100 begin 3037000499123 1234567890123 987654321 */ drop 1 - dup 0 = until drop ; ",
+      "muldiv-native", 2000 },
+    /* Shift and subtract division of the emulated product one bit at a time */
+    { "muldiv-emulated",
+      ": emu-um/mod ec swap ! 0 eq swap ! ehi @ 62 begin swap "
+      "  2 * elo @ 2 * dup d62 / -rot + swap d62 % elo swap ! "
+      "  eq @ 2 * eq swap ! "
+      "  dup ec @ >= if ec @ - eq @ 1 + eq swap ! then "
+      "  swap 1 - dup 0 = until drop eq @ ; "
+      ": muldiv-emulated 100 begin 3037000499123 1234567890123 emu-um* "
+      "  987654321 emu-um/mod drop drop 1 - dup 0 = until drop ; ",
+      "muldiv-emulated", 200 },
+    /* The determinant of a 2x2 matrix, with pick written in Forth as it was
+     * before it was a primitive, with the native pick, and with locals */
+    { "shuffle-ft-pick",
+      ": ft-pick 1 + CELLSZ * asp @ swap - @ ; "
+      ": det-ft 3 ft-pick 1 ft-pick * 3 ft-pick 3 ft-pick * - nip nip nip nip ; "
+      ": shuffle-ft-pick 100 begin 1 2 3 4 det-ft drop 1 - dup 0 = until drop ; ",
+      "shuffle-ft-pick", 2000 },
+    { "shuffle-native",
+      ": det-native 3 pick 1 pick * 3 pick 3 pick * - nip nip nip nip ; "
+      ": shuffle-native 100 begin 1 2 3 4 det-native drop 1 - dup 0 = until drop ; ",
+      "shuffle-native", 2000 },
+    { "shuffle-locals",
+      ": det-locals { a b c d -- n } a d * b c * - ; "
+      ": shuffle-locals 100 begin 1 2 3 4 det-locals drop 1 - dup 0 = until drop ; ",
+      "shuffle-locals", 2000 },
+};
+
+static char* Load_Source = NULL;
+value_t Argument_Stack[ARG_STACK_SZ];
+value_t Return_Stack[RET_STACK_SZ];
+value_t Word_Buffer[WORD_BUF_SZ];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+static void eval_str(char* source) {
+    (void)onward_eval(source, (value_t)strlen(source));
+}
+
+static char* read_file(char* fname) {
+    char* data = NULL;
+    FILE* file = fopen(fname, "r");
+    if (file) {
+        long size;
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        data = calloc((size_t)size + 1u, 1u);
+        if (data && (size != (long)fread(data, 1u, (size_t)size, file))) {
+            free(data);
+            data = NULL;
+        }
+        fclose(file);
+    }
+    return data;
+}
+
+/* Dispatched instructions are counted using a single entry trace buffer */
+static void count_start(void) {
+    static trace_t counter;
+    onward_trace_init(&counter, 1);
+}
+
+static value_t count_stop(void) {
+    value_t count = trpos;
+    onward_trace_init(NULL, 0);
+    return count;
+}
+
+/* The dictionary usage reported is the peak reached since the last report, as
+ * workloads such as file-load give back the space they use before finishing */
+static void report(char* name, long iters, double ns, value_t dispatches) {
+    double ns_per_op = ns / (double)iters;
+    double per_sec   = (ns_per_op > 0.0) ? ((double)dispatches * 1e9 / ns_per_op) : 0.0;
+    printf("%s\t%ld\t%.1f\t%.0f\t%zd\n", name, iters, ns_per_op, per_sec, stat_dict_max);
+    stat_dict_max = here - hbase;
+}
+
+static void bench_workload(workload_t* load) {
+    double best = 0.0;
+    value_t xt, dispatches;
+    int run;
+    long i;
+    eval_str(load->setup);
+    onward_aspush((value_t)load->word);
+    find_code();
+    xt = onward_aspop();
+    if (!xt) {
+        fprintf(stderr, "%s: unknown word '%s'\n", load->name, load->word);
+        return;
+    }
+    count_start();
+    onward_aspush(xt);
+    exec_code();
+    dispatches = count_stop();
+    for (run = 0; run < BENCH_REPEAT; run++) {
+        double start = now_ns();
+        for (i = 0; i < load->iters; i++) {
+            onward_aspush(xt);
+            exec_code();
+        }
+        start = now_ns() - start;
+        if ((run == 0) || (start < best))
+            best = start;
+    }
+    report(load->name, load->iters, best, dispatches);
+}
+
+static void bench_load(char* name, long iters) {
+    value_t here_start   = here;
+    value_t latest_start = latest;
+    value_t dispatches;
+    double best = 0.0;
+    int run;
+    long i;
+    for (run = 0; run < BENCH_REPEAT; run++) {
+        double start = now_ns();
+        for (i = 0; i < iters; i++) {
+            here   = here_start;
+            latest = latest_start;
+            eval_str(Load_Source);
+        }
+        start = now_ns() - start;
+        if ((run == 0) || (start < best))
+            best = start;
+    }
+    /* Count the dispatches of one final load which is kept for the workloads */
+    here   = here_start;
+    latest = latest_start;
+    count_start();
+    eval_str(Load_Source);
+    dispatches = count_stop();
+    report(name, iters, best, dispatches);
+}
+
+/* Evaluate a small expression in a separate instance sharing the dictionary */
+static void bench_vm_eval(char* name, long iters) {
+    static value_t arg_stack[64], ret_stack[64], word_buf[64];
+    static char source[] = "3 4 + 2 * drop";
+    onward_init_t init = {
+        arg_stack, sizeof(arg_stack),
+        ret_stack, sizeof(ret_stack),
+        word_buf,  sizeof(word_buf),
+        (word_t*)latest,
+        NULL, NULL
+    };
+    onward_vm_t vm;
+    value_t dispatches;
+    double best = 0.0;
+    int run;
+    long i;
+    onward_vm_init(&vm, &init);
+    count_start();
+    (void)onward_vm_eval(&vm, source, sizeof(source)-1);
+    dispatches = count_stop();
+    for (run = 0; run < BENCH_REPEAT; run++) {
+        double start = now_ns();
+        for (i = 0; i < iters; i++)
+            (void)onward_vm_eval(&vm, source, sizeof(source)-1);
+        start = now_ns() - start;
+        if ((run == 0) || (start < best))
+            best = start;
+    }
+    report(name, iters, best, dispatches);
+}
+
+/* Call a word from the host by name, with and without a cached handle */
+static void bench_host_call(char* name, long iters, bool cached) {
+    static value_t arg_stack[64], ret_stack[64], word_buf[64];
+    onward_init_t init = {
+        arg_stack, sizeof(arg_stack),
+        ret_stack, sizeof(ret_stack),
+        word_buf,  sizeof(word_buf),
+        (word_t*)latest,
+        NULL, NULL
+    };
+    onward_vm_t vm;
+    onward_xt_t xt;
+    double best = 0.0;
+    int run;
+    long i;
+    onward_vm_init(&vm, &init);
+    onward_xt_init(&xt, "nip");
+    for (run = 0; run < BENCH_REPEAT; run++) {
+        double start = now_ns();
+        for (i = 0; i < iters; i++) {
+            onward_vm_push(&vm, 1);
+            onward_vm_push(&vm, 2);
+            (void)onward_vm_call(&vm, cached ? onward_vm_resolve(&vm, &xt)
+                                             : onward_vm_find(&vm, "nip"));
+            (void)onward_vm_pop(&vm);
+        }
+        start = now_ns() - start;
+        if ((run == 0) || (start < best))
+            best = start;
+    }
+    report(name, iters, best, 4);
+}
+
+/* Map a word over an array with a given number of worker threads */
+static void bench_par_map(char* name, long iters, value_t threads) {
+    static value_t data[4096];
+    static char setup[] = ": par-work 64 begin swap 3 * 7 + swap 1 - dup 0 = until drop ; ";
+    value_t xt, dispatches;
+    double best = 0.0;
+    int run;
+    long i;
+    eval_str(setup);
+    onward_aspush((value_t)"par-work");
+    find_code();
+    xt = onward_aspop();
+    onward_aspush(threads);
+    par_threads_code();
+    count_start();
+    onward_aspush(0);
+    onward_aspush(xt);
+    exec_code();
+    dispatches = count_stop() * (sizeof(data) / sizeof(data[0]));
+    (void)onward_aspop();
+    for (run = 0; run < BENCH_REPEAT; run++) {
+        double start = now_ns();
+        for (i = 0; i < iters; i++) {
+            onward_aspush((value_t)data);
+            onward_aspush(sizeof(data) / sizeof(data[0]));
+            onward_aspush(xt);
+            par_map_code();
+        }
+        start = now_ns() - start;
+        if ((run == 0) || (start < best))
+            best = start;
+    }
+    report(name, iters, best, dispatches);
+}
+
+/* Increment one shared counter from a given number of worker threads with a
+ * plain +! or one of the atomic words. Lost updates of +! are reported. */
+static void bench_contention(char* name, long iters, value_t threads, char* word) {
+    static value_t data[1024];
+    static char setup[] =
+        "variable hits "
+        ": hit-plain drop 16 begin hits 1 +! 1 - dup 0 = until ; "
+        ": hit-relaxed drop 16 begin hits 1 relaxed atomic-add drop 1 - dup 0 = until ; "
+        ": hit-seq-cst drop 16 begin hits 1 seq-cst atomic-add drop 1 - dup 0 = until ; "
+        ": cas-inc 0 { v } begin hits relaxed atomic@ to v hits v v 1 + acq-rel atomic-cas v = until ; "
+        ": hit-cas drop 16 begin cas-inc 1 - dup 0 = until ; ";
+    static bool defined = false;
+    value_t xt, hits, expected;
+    double best = 0.0;
+    int run;
+    long i;
+    if (!defined) {
+        eval_str(setup);
+        defined = true;
+    }
+    onward_aspush((value_t)word);
+    find_code();
+    xt = onward_aspop();
+    onward_aspush((value_t)"hits");
+    find_code();
+    onward_aspush(onward_aspop());
+    exec_code();
+    hits = onward_aspop();
+    onward_aspush(threads);
+    par_threads_code();
+    *((value_t*)hits) = 0;
+    for (run = 0; run < BENCH_REPEAT; run++) {
+        double start = now_ns();
+        for (i = 0; i < iters; i++) {
+            onward_aspush((value_t)data);
+            onward_aspush(sizeof(data) / sizeof(data[0]));
+            onward_aspush(xt);
+            par_map_code();
+        }
+        start = now_ns() - start;
+        if ((run == 0) || (start < best))
+            best = start;
+    }
+    expected = BENCH_REPEAT * iters * 16 * (value_t)(sizeof(data) / sizeof(data[0]));
+    if (*((value_t*)hits) != expected)
+        fprintf(stderr, "%s: lost %zd of %zd updates\n", name, expected - *((value_t*)hits), expected);
+    report(name, iters, best, 0);
+}
+
+/* The number of cells moved by each run of a channel benchmark */
+#define CHAN_MESSAGES (1 << 20)
+
+/* The number of cells the benchmarked channels hold */
+#define CHAN_CAPACITY 1024
+
+/** A thread that sends its share of the messages of a channel benchmark */
+typedef struct {
+    pthread_t thread;
+    value_t chan;
+    value_t count;
+    value_t batch;
+    value_t arg_stack[16];
+    value_t ret_stack[16];
+} chan_sender_t;
+
+static void* chan_sender(void* arg) {
+    chan_sender_t* sender = (chan_sender_t*)arg;
+    onward_init_t init = {
+        sender->arg_stack, sizeof(sender->arg_stack),
+        sender->ret_stack, sizeof(sender->ret_stack),
+        NULL, 0, NULL, NULL, NULL
+    };
+    value_t cells[64] = { 0 }, i;
+    onward_init(&init);
+    for (i = 0; i < sender->count; i += sender->batch) {
+        if (sender->batch == 1) {
+            onward_aspush(i);
+            onward_aspush(sender->chan);
+            chan_send_code();
+        } else {
+            onward_aspush((value_t)cells);
+            onward_aspush(sender->batch);
+            onward_aspush(sender->chan);
+            chan_send_n_code();
+        }
+    }
+    return NULL;
+}
+
+/* Move cells through a channel from a number of sender threads to this thread
+ * one at a time or in batches, reporting the messages per second */
+static void bench_chan(char* name, value_t multi, value_t senders, value_t batch) {
+    chan_sender_t* threads = (chan_sender_t*)calloc((size_t)senders, sizeof(chan_sender_t));
+    value_t cells[64], chan, i, j;
+    double best = 0.0;
+    int run;
+    onward_aspush(CHAN_CAPACITY);
+    chan_bytes_code();
+    chan = (value_t)malloc((size_t)onward_aspop());
+    for (run = 0; run < BENCH_REPEAT; run++) {
+        double start;
+        onward_aspush(chan);
+        onward_aspush(CHAN_CAPACITY);
+        onward_aspush(multi);
+        chan_init_code();
+        (void)onward_aspop();
+        start = now_ns();
+        for (i = 0; i < senders; i++) {
+            threads[i].chan  = chan;
+            threads[i].count = CHAN_MESSAGES / senders;
+            threads[i].batch = batch;
+            pthread_create(&(threads[i].thread), NULL, chan_sender, &threads[i]);
+        }
+        for (j = 0; j < CHAN_MESSAGES; j += batch) {
+            if (batch == 1) {
+                onward_aspush(chan);
+                chan_recv_code();
+                (void)onward_aspop();
+            } else {
+                onward_aspush((value_t)cells);
+                onward_aspush(batch);
+                onward_aspush(chan);
+                chan_recv_n_code();
+            }
+        }
+        for (i = 0; i < senders; i++)
+            pthread_join(threads[i].thread, NULL);
+        start = now_ns() - start;
+        if ((run == 0) || (start < best))
+            best = start;
+    }
+    printf("%s\t%d\t%.1f\t%.0f\n", name, CHAN_MESSAGES, best / CHAN_MESSAGES, CHAN_MESSAGES * 1e9 / best);
+    free((void*)chan);
+    free(threads);
+}
+
+/* Sort pseudo-random cells with a Forth insertion sort, the native sort
+ * with a primitive or colon definition comparison, or the radix sort */
+static void bench_sort(char* name, value_t count, char* mode) {
+    static char setup[] =
+        "variable sa variable sj "
+        ": sa@ cells sa @ + ; "
+        ": prev-greater sj @ 0 > if sj @ 1 - sa@ @ sj @ sa@ @ > else 0 then ; "
+        ": xchg sj @ sa@ @ sj @ 1 - sa@ @ sj @ sa@ swap ! sj @ 1 - sa@ swap ! ; "
+        ": insert sj swap ! begin prev-greater while xchg sj @ 1 - sj swap ! repeat ; "
+        ": isort swap sa swap ! 1 begin over over > while dup insert 1 + repeat drop drop ; "
+        ": sort-less < ; ";
+    static bool defined = false;
+    value_t* data = (value_t*)malloc((size_t)count * sizeof(value_t));
+    value_t dispatches = 0, i;
+    word_t const* word = NULL;
+    double best = 0.0;
+    int run, runs = (count >= 1000000) ? 1 : BENCH_REPEAT;
+    if (!defined) {
+        eval_str(setup);
+        defined = true;
+    }
+    if (strcmp(mode, "radix")) {
+        onward_aspush((value_t)mode);
+        find_code();
+        word = (word_t const*)onward_aspop();
+    }
+    for (run = 0; run < runs; run++) {
+        double start;
+        uint32_t seed = 42;
+        for (i = 0; i < count; i++) {
+            seed = (seed * 1103515245u) + 12345u;
+            data[i] = (value_t)(seed >> 8u) - (1 << 23);
+        }
+        if (run == 0)
+            count_start();
+        start = now_ns();
+        onward_aspush((value_t)data);
+        onward_aspush(count);
+        if (!word) {
+            radix_sort_code();
+        } else if (!strcmp(mode, "isort")) {
+            onward_exec(word);
+        } else {
+            onward_aspush((value_t)word);
+            sort_code();
+        }
+        start = now_ns() - start;
+        if (run == 0)
+            dispatches = count_stop();
+        if ((run == 0) || (start < best))
+            best = start;
+    }
+    free(data);
+    report(name, 1, best, dispatches);
+}
+
+/* Run a program too large for the L1 cache, made of 48 words that each call 8
+ * of 384 arithmetic words, compiled to cell or token threaded code. The
+ * dictionary size of the program is reported. */
+static void bench_program(char* name, long iters, value_t use_tokens) {
+    static value_t arg_stack[64], ret_stack[64], word_buf[32768];
+    char* source = (char*)malloc(65536);
+    char* end    = source;
+    onward_init_t init = {
+        arg_stack, sizeof(arg_stack),
+        ret_stack, sizeof(ret_stack),
+        word_buf,  sizeof(word_buf),
+        (word_t*)latest,
+        NULL, NULL
+    };
+    onward_vm_t vm;
+    word_t const* word;
+    value_t dispatches;
+    double best = 0.0;
+    int run;
+    long i, j;
+    for (i = 0; i < 384; i++)
+        end += sprintf(end, ": l%ld %ld + dup 3 * swap 7 / + 1048575 & %ld ^ 1 + ; ", i, i, i * 31);
+    for (i = 0; i < 48; i++) {
+        end += sprintf(end, ": m%ld", i);
+        for (j = 0; j < 8; j++)
+            end += sprintf(end, " l%ld", (i * 8) + j);
+        end += sprintf(end, " ; ");
+    }
+    end += sprintf(end, ": program 1");
+    for (i = 0; i < 48; i++)
+        end += sprintf(end, " m%ld", i);
+    end += sprintf(end, " drop ; ");
+    onward_vm_init(&vm, &init);
+    tokens = use_tokens;
+    (void)onward_vm_eval(&vm, source, end - source);
+    tokens = 0;
+    free(source);
+    word = onward_vm_find(&vm, "program");
+    count_start();
+    (void)onward_vm_call(&vm, word);
+    dispatches = count_stop();
+    for (run = 0; run < BENCH_REPEAT; run++) {
+        double start = now_ns();
+        for (i = 0; i < iters; i++)
+            (void)onward_vm_call(&vm, word);
+        start = now_ns() - start;
+        if ((run == 0) || (start < best))
+            best = start;
+    }
+    printf("%s\t%ld\t%.1f\t%.0f\t%zd\n", name, iters, best / (double)iters,
+           (double)dispatches * 1e9 * (double)iters / best, vm.here - vm.hbase);
+    /* The peak of the separate instance is not carried into the next report */
+    stat_dict_max = here - hbase;
+}
+
+int main(int argc, char** argv) {
+    size_t i;
+    onward_init_t init = {
+        Argument_Stack, sizeof(Argument_Stack),
+        Return_Stack,   sizeof(Return_Stack),
+        Word_Buffer,    sizeof(Word_Buffer),
+        NULL, NULL, NULL
+    };
+    onward_init(&init);
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s ONWARD_FT\n", argv[0]);
+        return 1;
+    }
+    Load_Source = read_file(argv[1]);
+    if (!Load_Source) {
+        fprintf(stderr, "%s: unable to read file\n", argv[1]);
+        return 1;
+    }
+    puts("workload\titerations\tns_per_op\tdispatches_per_sec\tdict_bytes");
+    bench_load("file-load", 200);
+    for (i = 0; i < sizeof(Workloads)/sizeof(Workloads[0]); i++)
+        bench_workload(&Workloads[i]);
+    bench_vm_eval("vm-eval", 100000);
+    bench_host_call("host-call-find", 100000, false);
+    bench_host_call("host-call-handle", 100000, true);
+    bench_program("program-cells", 200, 0);
+    bench_program("program-tokens", 200, 1);
+    bench_par_map("par-map-1", 4, 1);
+    bench_par_map("par-map-2", 4, 2);
+    bench_par_map("par-map-4", 4, 4);
+    bench_par_map("par-map-8", 4, 8);
+    bench_contention("count-plain-1", 4, 1, "hit-plain");
+    bench_contention("count-plain-4", 4, 4, "hit-plain");
+    bench_contention("count-relaxed-1", 4, 1, "hit-relaxed");
+    bench_contention("count-relaxed-4", 4, 4, "hit-relaxed");
+    bench_contention("count-seq-cst-1", 4, 1, "hit-seq-cst");
+    bench_contention("count-seq-cst-4", 4, 4, "hit-seq-cst");
+    bench_contention("count-cas-1", 4, 1, "hit-cas");
+    bench_contention("count-cas-4", 4, 4, "hit-cas");
+    bench_sort("isort-1e3", 1000, "isort");
+    for (i = 1000; i <= 10000000; i *= 10) {
+        char name[32];
+        sprintf(name, "sort-lt-%zu", i);
+        bench_sort(name, (value_t)i, "<");
+        if (i <= 1000000) {
+            sprintf(name, "sort-xt-%zu", i);
+            bench_sort(name, (value_t)i, "sort-less");
+        }
+        sprintf(name, "radix-sort-%zu", i);
+        bench_sort(name, (value_t)i, "radix");
+    }
+    puts("\nworkload\tmessages\tns_per_msg\tmessages_per_sec");
+    bench_chan("chan-spsc", 0, 1, 1);
+    bench_chan("chan-spsc-batch-64", 0, 1, 64);
+    bench_chan("chan-mpmc", 1, 1, 1);
+    bench_chan("chan-mpmc-batch-64", 1, 1, 64);
+    bench_chan("chan-mpmc-4-senders", 1, 4, 1);
+    bench_chan("chan-mpmc-4-senders-batch-64", 1, 4, 64);
+    return 0;
+}
@@ -1,3 +1,8 @@
+/* perf_event_open is only reachable through syscall, which glibc declares for
+ * the default feature set */
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
 #include <onward.h>
 #include <onward_sys.h>
 
@@ -81,20 +86,92 @@ static syscall_fn_t System_Calls[7] = {
 /* Standalone Interpreter
  *****************************************************************************/
 #include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+/* The metacompiler is built from this file to load source files and emit
+ * them as C, which is then built into the interpreter as its dictionary */
+#ifdef ONWARD_META
+int onward_meta(char const* path, char* roots, char const* files);
+#endif
+#ifdef ONWARD_IMAGE
+extern word_t const* const Onward_Image;
+#endif
+
+/* The number of trace entries printed when a signal requests a dump */
+#define TRACE_DUMP_COUNT 32
+
+/** A file that has been loaded, identified by its canonical path and the
+ * modification time it had when it was loaded */
+typedef struct module_t {
+    struct module_t* next;
+    char* path;
+    time_t mtime;
+    /** The latest word once the file was loaded or 0 while it is loading */
+    value_t last;
+} module_t;
+
+static void pipe_eval(char const* source, value_t length, bool resume);
+
+/* Whether files are loaded with their words scanned by another thread */
+static bool Pipeline = false;
+/* The loaded files, shared by every thread that loads one */
+static module_t* Modules = NULL;
+static pthread_mutex_t Modules_Lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* The unit tests build this file without the interpreter's own buffers and
+ * entry point so they can call the words defined here */
+#ifndef ONWARD_TEST
 static bool Newline_Consumed = false;
 value_t Argument_Stack[ARG_STACK_SZ];
 value_t Return_Stack[RET_STACK_SZ];
 value_t Word_Buffer[WORD_BUF_SZ];
+#endif
 
 defvar("infile",  infile,  0u, LATEST_BUILTIN);
 defvar("outfile", outfile, 0u, &infile_word);
 defvar("errfile", errfile, 0u, &outfile_word);
-defcode("syscall", syscall, &errfile_word, 0u) {
+defcode("syscall", syscall_word, &errfile_word, 0u) {
     System_Calls[onward_aspop()]();
 }
 
-defcode("dumpw", dumpw, &syscall, 0u) {
+static void print_tokens(uint16_t const* toks) {
+    uint16_t const* start = toks;
+    printf("tokens:");
+    for (; *toks != TOKEN_EXIT; toks++) {
+        if (*toks & TOKEN_LITERAL) {
+            printf("\tlit %d", (int16_t)(*toks << 1) >> 1);
+        } else if (*toks == TOKEN_LIT) {
+            value_t val;
+            memcpy(&val, toks + 1, sizeof(value_t));
+            printf("\tlit %zd", val);
+            toks += TOKEN_CELL_UNITS;
+        } else if ((*toks == TOKEN_BR) || (*toks == TOKEN_ZBR)) {
+            printf("\t%s %d", (*toks == TOKEN_BR) ? "br" : "0br", (int16_t)toks[1]);
+            toks++;
+        } else if (*toks == TOKEN_TICK) {
+            printf("\t' %s", onward_token_word(*(++toks))->name);
+        } else {
+            word_t const* word = onward_token_word(*toks);
+            printf("\t%s", word->name);
+            if (onward_operand((value_t)word))
+                printf(" %d", *(++toks));
+        }
+        puts("");
+    }
+    printf("\tret\n");
+    printf("size:\t%zd bytes\n", (intptr_t)sizeof(value_t) + ((toks - start + 1) * (intptr_t)sizeof(uint16_t)));
+}
+
+defcode("dumpw", dumpw, &syscall_word, 0u) {
     word_t* word = (word_t*)onward_aspop();
     printf("name:\t'%s'\n", word->name);
     printf("flags:\t%#zx\n", word->flags);
@@ -102,12 +179,16 @@ defcode("dumpw", dumpw, &syscall, 0u) {
     /* Print the word's instructions */
     if (word->flags & F_PRIMITIVE_MSK) {
         printf("code:\t%p\n", word->code);
+    } else if (onward_token_code(word)) {
+        print_tokens(onward_token_code(word));
     } else {
         printf("code:");
         word_t** code = (word_t**)word->code;
         while(*code) {
             printf("\t%s", (*code)->name);
-            if ((*code == &lit) || (*code == &zbr) || (*code == &br))
+            if (*code == &tick)
+                printf(" %s", (*(++code))->name);
+            else if (onward_operand((value_t)*code))
                 printf(" %zd", (intptr_t)*(++code));
             code++;
             puts("");
@@ -116,6 +197,461 @@ defcode("dumpw", dumpw, &syscall, 0u) {
     }
 }
 
+static void print_trace(FILE* out, value_t count) {
+    value_t age;
+    for (age = count-1; age >= 0; age--) {
+        trace_t const* entry = onward_trace_entry(age);
+        if (entry) {
+            fprintf(out, "%5zd  %#zx\t%-16s\t%#zx\n", age, entry->pc,
+                (entry->word ? entry->word->name : "ret"), entry->tos);
+        }
+    }
+}
+
+defcode("trace.", trace_dot, &dumpw, 0u) {
+    print_trace(stdout, onward_aspop());
+}
+
+/* Record a file as loaded along with its current modification time */
+static module_t* module_add(char* fname) {
+    struct stat st;
+    module_t* mod;
+    char* path = realpath(fname, NULL);
+    if (!path || (0 != stat(path, &st))) {
+        free(path);
+        return NULL;
+    }
+    pthread_mutex_lock(&Modules_Lock);
+    for (mod = Modules; mod && strcmp(mod->path, path); mod = mod->next);
+    if (mod) {
+        free(path);
+    } else {
+        mod = (module_t*)malloc(sizeof(module_t));
+        mod->next = Modules;
+        mod->path = path;
+        Modules   = mod;
+    }
+    mod->mtime = st.st_mtime;
+    mod->last  = 0;
+    pthread_mutex_unlock(&Modules_Lock);
+    return mod;
+}
+
+/* Record the latest word once a file has been loaded */
+static void module_done(module_t* mod) {
+    if (mod) {
+        pthread_mutex_lock(&Modules_Lock);
+        mod->last = latest;
+        pthread_mutex_unlock(&Modules_Lock);
+    }
+}
+
+/* Check if a word is still in the dictionary, it may have been forgotten */
+static bool module_defined(value_t last) {
+    word_t const* word;
+    for (word = (word_t const*)latest; word && ((value_t)word != last); word = word->link);
+    return (0 == last) || (NULL != word);
+}
+
+/* Check if a file was loaded, has not been modified since, and its words have
+ * not been forgotten */
+static bool module_loaded(char* fname) {
+    module_t* mod;
+    bool loaded = false;
+    char* path = realpath(fname, NULL);
+    pthread_mutex_lock(&Modules_Lock);
+    for (mod = Modules; path && mod && !loaded; mod = mod->next) {
+        struct stat st;
+        loaded = (!strcmp(mod->path, path) && (0 == stat(path, &st)) &&
+                  (mod->mtime == st.st_mtime) && module_defined(mod->last));
+    }
+    pthread_mutex_unlock(&Modules_Lock);
+    free(path);
+    return loaded;
+}
+
+/* Read the whole of an open file into a new buffer */
+static char* read_source(FILE* file, long* size) {
+    char* data;
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data = (*size >= 0) ? malloc((size_t)*size + 1u) : NULL;
+    if (data && (*size != (long)fread(data, 1u, (size_t)*size, file))) {
+        free(data);
+        data = NULL;
+    }
+    return data;
+}
+
+/* Read the whole file and interpret it as a nested input source */
+static void load_file(char* fname) {
+    char* data = NULL;
+    long size  = 0;
+    FILE* file = fopen(fname, "r");
+    if (file) {
+        data = read_source(file, &size);
+        fclose(file);
+    }
+    if (data) {
+        module_t* mod = module_add(fname);
+        if (Pipeline)
+            pipe_eval(data, size, false);
+        else
+            (void)onward_eval(data, size);
+        module_done(mod);
+        free(data);
+    } else {
+        onward_throw(ERR_FILE_NOT_FOUND);
+    }
+}
+
+/** Interpret the file with the given name */
+defcode("included", included, &trace_dot, 0u) {
+    load_file((char*)onward_aspop());
+}
+
+/** Interpret the file with the given name unless it is unchanged since it
+ * was last loaded */
+defcode("required", required, &included, 0u) {
+    char* fname = (char*)onward_aspop();
+    if (!module_loaded(fname))
+        load_file(fname);
+}
+
+static bool is_space(value_t ch) {
+    return ((ch == ' ') || (ch == '\t') || (ch == '\r') || (ch == '\n'));
+}
+
+/* Read the next word of input into a path buffer of PATH_MAX bytes. Unlike
+ * word the name is not truncated, a name too long for the buffer throws. */
+static char* read_path(char* path) {
+    size_t len = 0;
+    value_t curr;
+    do {
+        key_code();
+        curr = onward_aspop();
+    } while (is_space(curr));
+    while ((curr != EOF) && !is_space(curr)) {
+        if (len == (PATH_MAX - 1u)) {
+            onward_throw(ERR_FILE_NOT_FOUND);
+            return NULL;
+        }
+        path[len++] = (char)curr;
+        key_code();
+        curr = onward_aspop();
+    }
+    path[len] = '\0';
+    return path;
+}
+
+/** Interpret the file named by the next word of input */
+defcode("include", include, &required, 0u) {
+    char path[PATH_MAX];
+    if (read_path(path))
+        load_file(path);
+}
+
+/** Interpret the file named by the next word of input unless it is unchanged
+ * since it was last loaded */
+defcode("require", require, &include, 0u) {
+    char path[PATH_MAX];
+    if (read_path(path) && !module_loaded(path))
+        load_file(path);
+}
+
+/* The size of the blocks read by each-line */
+#define LINE_BLOCK_SZ (64u * 1024u)
+
+/* The buffer each-line reads into, kept for the next call. It grows to hold
+ * the longest line and a nested call allocates its own. */
+static ONWARD_TLS char* Line_Buffer = NULL;
+static ONWARD_TLS size_t Line_Buffer_Sz = 0;
+
+/* Push the arguments and run a word to completion, calling primitives
+ * directly. Returns the error the word threw so that the caller can release
+ * what it holds before passing the error on. */
+static value_t call_word(word_t const* word, value_t const* args, value_t count) {
+    onward_frame_t frame;
+    value_t i;
+    onward_frame_push(&frame);
+    if (0 == setjmp(frame.jump)) {
+        for (i = 0; i < count; i++)
+            onward_aspush(args[i]);
+        if (word->flags & F_PRIMITIVE_MSK)
+            ((primitive_t)word->code)();
+        else
+            onward_exec(word);
+    }
+    onward_frame_pop(&frame);
+    return frame.code;
+}
+
+/** Execute a word for each line of a file with the address and length of the
+ * line, without its newline. The line is only valid until the word returns.
+ * Pushes non-zero if the file could not be read. */
+defcode("each-line", each_line, &require, 0u) {
+    word_t const* word = (word_t const*)onward_aspop();
+    FILE* fhndl  = (FILE*)onward_aspop();
+    char* buf    = Line_Buffer;
+    size_t size  = Line_Buffer_Sz;
+    size_t len   = 0, start, nread;
+    value_t fail = 0, code = 0;
+    Line_Buffer = NULL;
+    if (!fhndl) {
+        onward_aspush(1);
+        return;
+    } else if (!buf) {
+        size = LINE_BLOCK_SZ;
+        buf  = (char*)malloc(size);
+    }
+    /* A thrown error clears pc and stops the iteration */
+    while (buf && pc && !errcode) {
+        nread = fread(buf + len, 1u, size - len, fhndl);
+        if (nread == 0)
+            break;
+        len += nread;
+        for (start = 0; pc && !errcode;) {
+            char* end = (char*)memchr(buf + start, '\n', len - start);
+            value_t args[2];
+            if (!end)
+                break;
+            args[0] = (value_t)(buf + start);
+            args[1] = end - (buf + start);
+            code  = call_word(word, args, 2);
+            start = (size_t)(end - buf) + 1u;
+        }
+        /* Keep the start of a line that spans blocks, growing the buffer if
+         * the line fills it */
+        memmove(buf, buf + start, len - start);
+        len -= start;
+        if (len == size) {
+            char* grown = (char*)realloc(buf, 2u * size);
+            if (!grown) {
+                fail = 1;
+                break;
+            }
+            buf   = grown;
+            size *= 2u;
+        }
+    }
+    /* The last line may not end with a newline */
+    if (buf && !fail && (len > 0) && pc && !errcode) {
+        value_t args[2];
+        args[0] = (value_t)buf;
+        args[1] = (value_t)len;
+        code = call_word(word, args, 2);
+    }
+    fail = (fail || !buf || ferror(fhndl));
+    if (buf && !Line_Buffer) {
+        Line_Buffer    = buf;
+        Line_Buffer_Sz = size;
+    } else {
+        free(buf);
+    }
+    if (code)
+        onward_throw(code);
+    else
+        onward_aspush(fail);
+}
+
+/* Timing Words
+ *****************************************************************************/
+#include <time.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+/** A hardware event counted by perf */
+typedef struct {
+    char const* name;
+    uint32_t type;
+    uint64_t config;
+} perf_counter_t;
+
+static const perf_counter_t Perf_Counters[] = {
+    { "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "cache-misses",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+#define PERF_COUNTER_COUNT (sizeof(Perf_Counters) / sizeof(Perf_Counters[0]))
+#else
+/* No events are counted but the array of counters must not be empty */
+#define PERF_COUNTER_COUNT 1u
+#endif
+
+static uint64_t time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * UINT64_C(1000000000)) + (uint64_t)ts.tv_nsec;
+}
+
+/* Print a string through emit so it reaches the same output as the words */
+static void emit_str(char const* str) {
+    while (*str) {
+        onward_aspush((unsigned char)*str++);
+        emit_code();
+    }
+}
+
+static int compare_u64(void const* lval, void const* rval) {
+    uint64_t l = *(uint64_t const*)lval, r = *(uint64_t const*)rval;
+    return (l > r) - (l < r);
+}
+
+/* Open a counter for each of the perf events, returning 0 and closing any
+ * that were opened if one of them is not allowed */
+static int perf_open(int* fds) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    size_t i, j;
+    for (i = 0; i < PERF_COUNTER_COUNT; i++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = Perf_Counters[i].type;
+        attr.config         = Perf_Counters[i].config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fds[i] < 0) {
+            for (j = 0; j < i; j++)
+                close(fds[j]);
+            return 0;
+        }
+    }
+    return 1;
+#else
+    (void)fds;
+    return 0;
+#endif
+}
+
+static void perf_enable(int* fds, int enable) {
+#ifdef __linux__
+    size_t i;
+    for (i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (enable)
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fds[i], enable ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+    }
+#else
+    (void)fds;
+    (void)enable;
+#endif
+}
+
+/* Print the events counted per call and close the counters. Nothing is
+ * printed where perf is not available. */
+static void perf_report(int* fds, int counting, value_t runs) {
+#ifdef __linux__
+    char buf[128];
+    size_t i;
+    for (i = 0; i < PERF_COUNTER_COUNT; i++) {
+        uint64_t val = 0;
+        if (counting && (read(fds[i], &val, sizeof(val)) == (ssize_t)sizeof(val)))
+            sprintf(buf, "%s:\t%.1f per call\n", Perf_Counters[i].name, (double)val / (double)runs);
+        else
+            sprintf(buf, "%s:\tunavailable\n", Perf_Counters[i].name);
+        emit_str(buf);
+        if (counting)
+            close(fds[i]);
+    }
+#else
+    (void)fds;
+    (void)counting;
+    (void)runs;
+#endif
+}
+
+/** Push the time in microseconds from a monotonic clock */
+defcode("utime", utime, &each_line, 0u) {
+    onward_aspush((value_t)(time_ns() / 1000u));
+}
+
+/** Push the time in nanoseconds from a monotonic clock */
+defcode("ntime", ntime, &utime, 0u) {
+    onward_aspush((value_t)time_ns());
+}
+
+/** Push the processor's cycle or timer count, or the time in nanoseconds if
+ * it cannot be read */
+defcode("rdtsc", rdtsc, &ntime, 0u) {
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+    onward_aspush((value_t)(((uint64_t)hi << 32u) | lo));
+#elif defined(__aarch64__)
+    uint64_t val;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r"(val));
+    onward_aspush((value_t)val);
+#else
+    onward_aspush((value_t)time_ns());
+#endif
+}
+
+/** Execute a word the given number of times, timing each call, and print the
+ * fastest, median, and 99th percentile time of a call */
+defcode("bench", bench, &rdtsc, 0u) {
+    value_t count      = onward_aspop();
+    word_t const* word = (word_t const*)onward_aspop();
+    uint64_t* samples  = (count > 0) ? (uint64_t*)malloc((size_t)count * sizeof(uint64_t)) : NULL;
+    value_t runs, code = 0;
+    char buf[128];
+    if (!samples)
+        return;
+    /* A thrown error clears pc and stops the runs */
+    for (runs = 0; (runs < count) && pc && !errcode; runs++) {
+        uint64_t start = time_ns();
+        code = call_word(word, NULL, 0);
+        samples[runs] = time_ns() - start;
+    }
+    if (runs > 0) {
+        qsort(samples, (size_t)runs, sizeof(uint64_t), compare_u64);
+        sprintf(buf, "runs: %zd\tmin: %llu ns\tmedian: %llu ns\tp99: %llu ns\n", (intptr_t)runs,
+                (unsigned long long)samples[0], (unsigned long long)samples[runs / 2],
+                (unsigned long long)samples[(runs * 99) / 100]);
+        emit_str(buf);
+    }
+    free(samples);
+    if (code)
+        onward_throw(code);
+}
+
+/** Execute a word the given number of times and print the time and the
+ * hardware events counted per call. Only the time is printed if the counters
+ * are not available. */
+defcode("perf", perf, &bench, 0u) {
+    value_t count      = onward_aspop();
+    word_t const* word = (word_t const*)onward_aspop();
+    int fds[PERF_COUNTER_COUNT];
+    int counting = perf_open(fds);
+    uint64_t start;
+    value_t runs, code = 0;
+    char buf[128];
+    start = time_ns();
+    if (counting)
+        perf_enable(fds, 1);
+    for (runs = 0; (runs < count) && pc && !errcode; runs++)
+        code = call_word(word, NULL, 0);
+    if (counting)
+        perf_enable(fds, 0);
+    start = time_ns() - start;
+    if (runs == 0)
+        runs = 1;
+    sprintf(buf, "time:\t\t%.1f ns per call\n", (double)start / (double)runs);
+    emit_str(buf);
+    perf_report(fds, counting, runs);
+    if (code)
+        onward_throw(code);
+}
+
+#ifndef ONWARD_TEST
 value_t fetch_char(void)
 {
     value_t ch = (value_t)fgetc((FILE*)infile);
@@ -146,6 +682,67 @@ void print_stack(void) {
     puts(!errcode ? "OK." : "?");
 }
 
+/* Append a string or a number to a line of the trace dump. stdio is not safe
+ * to call from a signal handler so the dump is formatted by hand. */
+static char* trace_str(char* out, char const* str, size_t width) {
+    size_t len = 0;
+    for (; *str && (len < 32u); len++)
+        *out++ = *str++;
+    for (; len < width; len++)
+        *out++ = ' ';
+    return out;
+}
+
+static char* trace_num(char* out, uvalue_t val, uvalue_t base) {
+    char digits[2u * sizeof(uvalue_t) * 4u];
+    size_t count = 0;
+    do {
+        digits[count++] = "0123456789abcdef"[val % base];
+        val /= base;
+    } while (val);
+    if (base == 16u)
+        out = trace_str(out, "0x", 0u);
+    while (count)
+        *out++ = digits[--count];
+    return out;
+}
+
+static void trace_signal(int sig) {
+    char line[128];
+    char* out;
+    value_t age;
+    out = trace_str(line, "\nInstruction trace (", 0u);
+    out = trace_num(out, (uvalue_t)trpos, 10u);
+    out = trace_str(out, " dispatched):\n", 0u);
+    (void)!write(STDERR_FILENO, line, (size_t)(out - line));
+    for (age = TRACE_DUMP_COUNT-1; age >= 0; age--) {
+        trace_t const* entry = onward_trace_entry(age);
+        if (entry) {
+            out = trace_num(line, (uvalue_t)age, 10u);
+            out = trace_str(out, "\t", 0u);
+            out = trace_num(out, (uvalue_t)entry->pc, 16u);
+            out = trace_str(out, "\t", 0u);
+            out = trace_str(out, (entry->word ? entry->word->name : "ret"), 16u);
+            out = trace_str(out, "\t", 0u);
+            out = trace_num(out, (uvalue_t)entry->tos, 16u);
+            out = trace_str(out, "\n", 0u);
+            (void)!write(STDERR_FILENO, line, (size_t)(out - line));
+        }
+    }
+    /* Let the default handler terminate the process on abort */
+    if (sig == SIGABRT) {
+        signal(SIGABRT, SIG_DFL);
+        raise(SIGABRT);
+    }
+}
+
+static void trace_enable(value_t count) {
+    trace_t* buf = (trace_t*)malloc(count * sizeof(trace_t));
+    onward_trace_init(buf, count);
+    signal(SIGUSR1, trace_signal);
+    signal(SIGABRT, trace_signal);
+}
+
 void parse(FILE* file) {
     value_t old = infile;
     infile = (value_t)file;
@@ -167,23 +764,529 @@ void parse(FILE* file) {
 void parse_file(char* fname) {
     FILE* file = fopen(fname, "r");
     if (file) {
-        parse(file);
+        module_t* mod = module_add(fname);
+        long size;
+        char* data = Pipeline ? read_source(file, &size) : NULL;
+        if (data) {
+            value_t old = infile;
+            infile = (value_t)file;
+            pipe_eval(data, size, true);
+            infile = old;
+            /* Like reading the file through fetch_char */
+            Newline_Consumed = (Newline_Consumed || memchr(data, '\n', (size_t)size));
+            free(data);
+        } else {
+            parse(file);
+        }
+        module_done(mod);
         fclose(file);
     }
 }
+#endif
+
+/* Pipelined Loading
+ *****************************************************************************/
+#include <pthread.h>
+#include <sched.h>
+
+/* The number of scanned words the queue holds, a power of two */
+#define PIPE_SIZE 1024u
+
+/** A queue of the words of a source scanned by a thread ahead of the
+ * interpreter. The scanner only writes tail and the interpreter only writes
+ * head, so no locks are needed. */
+typedef struct {
+    char const* source;
+    char const* end;
+    /** The number of words taken by the interpreter */
+    size_t head;
+    /** The number of words written by the scanner */
+    size_t tail;
+    /** Set by the scanner once every word has been written */
+    int done;
+    /** Set by the interpreter to stop the scanner early */
+    int stop;
+    onward_scan_t words[PIPE_SIZE];
+} pipe_t;
+
+static void* pipe_scan(void* arg) {
+    pipe_t* pipe = (pipe_t*)arg;
+    char const* next = pipe->source;
+    size_t tail = 0;
+    while ((next = onward_scan(next, pipe->end, &(pipe->words[tail & (PIPE_SIZE - 1u)])))) {
+        /* Publish the word and wait for a free slot for the next one */
+        __atomic_store_n(&(pipe->tail), ++tail, __ATOMIC_RELEASE);
+        while ((tail - __atomic_load_n(&(pipe->head), __ATOMIC_ACQUIRE)) >= PIPE_SIZE) {
+            if (__atomic_load_n(&(pipe->stop), __ATOMIC_ACQUIRE))
+                return NULL;
+            sched_yield();
+        }
+    }
+    __atomic_store_n(&(pipe->done), 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static value_t pipe_next(char const* start, onward_scan_t* scan, void* ctx) {
+    pipe_t* pipe = (pipe_t*)ctx;
+    size_t head  = pipe->head;
+    for (;;) {
+        int done    = __atomic_load_n(&(pipe->done), __ATOMIC_ACQUIRE);
+        size_t tail = __atomic_load_n(&(pipe->tail), __ATOMIC_ACQUIRE);
+        onward_scan_t const* word = &(pipe->words[head & (PIPE_SIZE - 1u)]);
+        if (head == tail) {
+            if (done)
+                return 0;
+            sched_yield();
+        /* Words that start before the input were read by a word like \ or s"
+         * that reads the input itself */
+        } else if (word->start < start) {
+            __atomic_store_n(&(pipe->head), ++head, __ATOMIC_RELEASE);
+        } else if (word->start == start) {
+            *scan = *word;
+            __atomic_store_n(&(pipe->head), ++head, __ATOMIC_RELEASE);
+            return 1;
+        } else {
+            return 0;
+        }
+    }
+}
+
+/* Interpret a source while its words are scanned by another thread. An error
+ * stops the interpretation unless resume is set, then it continues after the
+ * word that failed like the REPL does. */
+static void pipe_eval(char const* source, value_t length, bool resume) {
+    pipe_t* pipe = (pipe_t*)calloc(1u, sizeof(pipe_t));
+    onward_scan_fn_t next = NULL;
+    char const* end = source + length;
+    char const* prev;
+    pthread_t thread;
+    if (pipe) {
+        pipe->source = source;
+        pipe->end    = end;
+        if (!pthread_create(&thread, NULL, pipe_scan, pipe))
+            next = pipe_next;
+    }
+    /* The source is interpreted the same way without a scanner */
+    do {
+        prev   = source;
+        source = onward_eval_scanned(source, end - source, next, pipe);
+    } while (resume && (source < end) && (source != prev));
+    if (next) {
+        __atomic_store_n(&(pipe->stop), 1, __ATOMIC_RELEASE);
+        pthread_join(thread, NULL);
+    }
+    free(pipe);
+}
+
+/* Server Mode
+ *****************************************************************************/
+#ifndef ONWARD_TEST
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+/* The number of cells in the stacks and word buffer of each pooled instance */
+#define SERVER_STACK_SZ    128
+#define SERVER_WORD_BUF_SZ 4096
+
+/* The largest request that will be evaluated */
+#define SERVER_REQUEST_MAX (1024 * 1024)
+
+/** An interpreter instance of the pool along with the thread that serves
+ * requests with it */
+typedef struct {
+    pthread_t thread;
+    onward_vm_t vm;
+    onward_init_t init;
+    value_t arg_stack[SERVER_STACK_SZ];
+    value_t ret_stack[SERVER_STACK_SZ];
+    value_t word_buf[SERVER_WORD_BUF_SZ];
+} server_worker_t;
+
+static int Server_Fd = -1;
+static char const* Server_Path = NULL;
+
+/* The limits of each request, 0 if unlimited. See onward_vm_limit(). */
+static value_t Server_Fuel = 0;
+static value_t Server_Timeout_NS = 0;
+static value_t Server_Quota = 0;
+
+/* The connection served by the thread and the output not yet sent to it */
+static ONWARD_TLS int Client_Fd = -1;
+static ONWARD_TLS size_t Client_Len = 0;
+static ONWARD_TLS char Client_Out[4096];
+
+static void server_flush(void) {
+    size_t sent = 0;
+    while (sent < Client_Len) {
+        ssize_t count = write(Client_Fd, Client_Out + sent, Client_Len - sent);
+        if ((count < 0) && (errno == EINTR))
+            continue;
+        if (count <= 0)
+            break;
+        sent += (size_t)count;
+    }
+    Client_Len = 0;
+}
+
+/* Output of emit is streamed to the client as the buffer fills */
+static void server_emit(value_t ch) {
+    Client_Out[Client_Len++] = (char)ch;
+    if (Client_Len == sizeof(Client_Out))
+        server_flush();
+}
+
+/* Read the request until the client shuts down its side of the connection,
+ * returning the length or -1 if it failed or is too large */
+static ssize_t server_read(int fd, char** buf, size_t* size) {
+    size_t len = 0;
+    for (;;) {
+        ssize_t count;
+        if (len == *size) {
+            char* grown = (*size < SERVER_REQUEST_MAX) ? realloc(*buf, *size ? (*size * 2) : 4096) : NULL;
+            if (!grown)
+                return -1;
+            *buf  = grown;
+            *size = *size ? (*size * 2) : 4096;
+        }
+        count = read(fd, *buf + len, *size - len);
+        if ((count < 0) && (errno == EINTR))
+            continue;
+        if (count < 0)
+            return -1;
+        if (count == 0)
+            return (ssize_t)len;
+        len += (size_t)count;
+    }
+}
+
+/* Accept connections and evaluate each request in a freshly reset instance.
+ * Words defined by a request only live until the next one starts. */
+static void* server_worker(void* arg) {
+    server_worker_t* worker = (server_worker_t*)arg;
+    char* request = NULL;
+    size_t size   = 0;
+    for (;;) {
+        ssize_t len;
+        int fd = accept(Server_Fd, NULL, NULL);
+        if (fd < 0) {
+            if ((errno == EINTR) || (errno == ECONNABORTED))
+                continue;
+            perror("accept");
+            break;
+        }
+        len = server_read(fd, &request, &size);
+        Client_Fd  = fd;
+        Client_Len = 0;
+        if (len >= 0) {
+            value_t err;
+            onward_vm_init(&(worker->vm), &(worker->init));
+            onward_vm_limit(&(worker->vm), Server_Fuel, Server_Timeout_NS, Server_Quota);
+            err = onward_vm_eval(&(worker->vm), request, (value_t)len);
+            if (err != ERR_NONE) {
+                char msg[32];
+                char* curr = msg;
+                sprintf(msg, "\nerrcode: %zd\n", err);
+                while (*curr)
+                    server_emit(*curr++);
+            }
+        }
+        server_flush();
+        close(fd);
+        Client_Fd = -1;
+    }
+    free(request);
+    return NULL;
+}
+
+/* The worker processes of the prefork mode, the parent stops them on exit */
+static pid_t* Server_Workers = NULL;
+static long Server_Worker_Count = 0;
+static volatile sig_atomic_t Server_Report = 0;
+
+static void server_signal(int sig) {
+    long i;
+    (void)sig;
+    for (i = 0; i < Server_Worker_Count; i++) {
+        if (Server_Workers[i] > 0)
+            kill(Server_Workers[i], SIGTERM);
+    }
+    unlink(Server_Path);
+    _exit(0);
+}
+
+static void server_report_signal(int sig) {
+    (void)sig;
+    Server_Report = 1;
+}
+
+/* Create the unix socket that requests are accepted from */
+static int server_listen(char const* path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "%s: socket path is too long\n", path);
+        return 1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    Server_Path = path;
+    Server_Fd   = socket(AF_UNIX, SOCK_STREAM, 0);
+    (void)unlink(path);
+    if ((Server_Fd < 0) || bind(Server_Fd, (struct sockaddr*)&addr, sizeof(addr)) ||
+        listen(Server_Fd, 128)) {
+        perror(path);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, server_signal);
+    signal(SIGTERM, server_signal);
+    return 0;
+}
+
+/* Serve requests with a pool of instances that share the words loaded so far */
+static int server_pool(long pool) {
+    server_worker_t* workers;
+    long i;
+    workers = (server_worker_t*)calloc((size_t)pool, sizeof(server_worker_t));
+    for (i = 0; workers && (i < pool); i++) {
+        server_worker_t* worker = &workers[i];
+        worker->init.arg_stack    = worker->arg_stack;
+        worker->init.arg_stack_sz = sizeof(worker->arg_stack);
+        worker->init.ret_stack    = worker->ret_stack;
+        worker->init.ret_stack_sz = sizeof(worker->ret_stack);
+        worker->init.word_buf     = worker->word_buf;
+        worker->init.word_buf_sz  = sizeof(worker->word_buf);
+        worker->init.latest       = (word_t*)latest;
+        worker->init.emit_char    = server_emit;
+        if (pthread_create(&(worker->thread), NULL, server_worker, worker)) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    for (i = 0; workers && (i < pool); i++)
+        pthread_join(workers[i].thread, NULL);
+    return 0;
+}
+
+/* Serve requests on a unix socket with a pool of instances in this process */
+static int server_run(char const* path, long pool) {
+    if (server_listen(path))
+        return 1;
+    printf("Serving on %s with %ld instances\n", path, pool);
+    fflush(stdout);
+    server_pool(pool);
+    unlink(path);
+    return 0;
+}
+
+/* Count the resident pages of the loaded words in a process and how many of
+ * them are mapped only by that process */
+static void server_dict_pages(pid_t pid, long* pages, long* exclusive) {
+#ifdef __linux__
+    char path[64];
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t addr = (uintptr_t)Word_Buffer & ~(page - 1);
+    uint64_t entry;
+    FILE* pagemap;
+    sprintf(path, "/proc/%d/pagemap", (int)pid);
+    if (!(pagemap = fopen(path, "rb")))
+        return;
+    for (; addr < (uintptr_t)here; addr += page) {
+        if (fseek(pagemap, (long)((addr / page) * sizeof(entry)), SEEK_SET) ||
+            (fread(&entry, sizeof(entry), 1u, pagemap) != 1u))
+            break;
+        /* Bit 63 marks a present page and bit 56 an exclusively mapped one */
+        if (entry & (1ull << 63)) {
+            *pages += 1;
+            *exclusive += !!(entry & (1ull << 56));
+        }
+    }
+    fclose(pagemap);
+#else
+    (void)pid;
+    (void)pages;
+    (void)exclusive;
+#endif
+}
+
+/* Print the resident memory of a process in kB, how much of it is shared with
+ * other processes, and whether the pages of the loaded words are shared */
+static void server_memory(char const* name, pid_t pid) {
+#ifdef __linux__
+    char path[64], line[256];
+    long rss = 0, pss = 0, shared = 0, private = 0, pages = 0, exclusive = 0, kb;
+    FILE* smaps;
+    sprintf(path, "/proc/%d/smaps_rollup", (int)pid);
+    if (!(smaps = fopen(path, "r")))
+        return;
+    while (fgets(line, sizeof(line), smaps)) {
+        if (sscanf(line, "Rss: %ld", &kb) == 1)
+            rss = kb;
+        else if (sscanf(line, "Pss: %ld", &kb) == 1)
+            pss = kb;
+        else if ((sscanf(line, "Shared_Clean: %ld", &kb) == 1) || (sscanf(line, "Shared_Dirty: %ld", &kb) == 1))
+            shared += kb;
+        else if ((sscanf(line, "Private_Clean: %ld", &kb) == 1) || (sscanf(line, "Private_Dirty: %ld", &kb) == 1))
+            private += kb;
+    }
+    fclose(smaps);
+    server_dict_pages(pid, &pages, &exclusive);
+    printf("%s\t%d\t%ld\t%ld\t%ld\t%ld\t%ld\t%ld\n", name, (int)pid, rss, pss, shared, private, pages, exclusive);
+#else
+    (void)name;
+    (void)pid;
+#endif
+}
+
+static void server_report(void) {
+    long i;
+    puts("process\tpid\trss_kb\tpss_kb\tshared_kb\tprivate_kb\tdict_pages\tdict_private_pages");
+    server_memory("parent", getpid());
+    for (i = 0; i < Server_Worker_Count; i++)
+        server_memory("worker", Server_Workers[i]);
+    fflush(stdout);
+}
+
+/* Start a worker process that serves requests from the shared socket. It
+ * inherits the loaded words copy-on-write and never writes to them. */
+static pid_t server_fork(long pool) {
+    pid_t pid;
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0) {
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGUSR1, SIG_DFL);
+        _exit(server_pool(pool));
+    } else if (pid < 0) {
+        perror("fork");
+    }
+    return pid;
+}
+
+/* Serve requests on a unix socket with worker processes forked once the files
+ * are loaded. Workers that exit are replaced and SIGUSR1 prints the memory
+ * used by each of them. */
+static int server_prefork(char const* path, long count, long pool) {
+    struct sigaction report;
+    long i;
+    if (server_listen(path))
+        return 1;
+    Server_Workers = (pid_t*)calloc((size_t)count, sizeof(pid_t));
+    if (!Server_Workers) {
+        perror("calloc");
+        return 1;
+    }
+    /* The report is printed once the signal interrupts the wait */
+    memset(&report, 0, sizeof(report));
+    report.sa_handler = server_report_signal;
+    sigaction(SIGUSR1, &report, NULL);
+    printf("Serving on %s with %ld workers of %ld instances\n", path, count, pool);
+    for (i = 0; i < count; i++)
+        Server_Workers[Server_Worker_Count++] = server_fork(pool);
+    for (;;) {
+        int status;
+        pid_t pid = wait(&status);
+        if (Server_Report) {
+            Server_Report = 0;
+            server_report();
+        }
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("wait");
+            break;
+        }
+        for (i = 0; i < Server_Worker_Count; i++) {
+            if (Server_Workers[i] == pid) {
+                fprintf(stderr, "worker %d exited with status 0x%x, restarting\n", (int)pid, status);
+                Server_Workers[i] = server_fork(pool);
+            }
+        }
+    }
+    unlink(path);
+    return 1;
+}
 
 int main(int argc, char** argv) {
     int i;
+    char* serve  = NULL;
+    long pool    = 4;
+    long prefork = 0;
+#ifdef ONWARD_META
+    char* meta  = NULL;
+    char* roots = NULL;
+    char files[1024] = "";
+#endif
+    onward_init_t init = {
+        Argument_Stack, sizeof(Argument_Stack),
+        Return_Stack,   sizeof(Return_Stack),
+        Word_Buffer,    sizeof(Word_Buffer),
+#ifdef ONWARD_IMAGE
+        (word_t*)Onward_Image,
+#else
+        (word_t*)&perf,
+#endif
+        fetch_char,
+        emit_char
+    };
     /* Initialize implementation specific words */
-    latest  = (value_t)&dumpw;
+    onward_init(&init);
     infile  = (value_t)stdin;
     outfile = (value_t)stdout;
     errfile = (value_t)stderr;
     /* Load any dictionaries specified on the  command line */
-    for (i = 1; i < argc; i++)
-        parse_file(argv[i]);
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--trace") && (i+1 < argc))
+            trace_enable((value_t)strtol(argv[++i], NULL, 0));
+        else if (!strcmp(argv[i], "--serve") && (i+1 < argc))
+            serve = argv[++i];
+        else if (!strcmp(argv[i], "--pool") && (i+1 < argc))
+            pool = strtol(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--prefork") && (i+1 < argc))
+            prefork = strtol(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--fuel") && (i+1 < argc))
+            Server_Fuel = (value_t)strtol(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--timeout") && (i+1 < argc))
+            Server_Timeout_NS = (value_t)strtol(argv[++i], NULL, 0) * 1000000;
+        else if (!strcmp(argv[i], "--quota") && (i+1 < argc))
+            Server_Quota = (value_t)strtol(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--pipeline"))
+            Pipeline = true;
+#ifdef ONWARD_META
+        else if (!strcmp(argv[i], "--meta") && (i+1 < argc))
+            meta = argv[++i];
+        else if (!strcmp(argv[i], "--roots") && (i+1 < argc))
+            roots = argv[++i];
+#endif
+        else {
+#ifdef ONWARD_META
+            if ((strlen(files) + strlen(argv[i]) + 2) < sizeof(files))
+                strcat(strcat(files, *files ? " " : ""), argv[i]);
+#endif
+            parse_file(argv[i]);
+        }
+    }
+#ifdef ONWARD_META
+    /* Emit the loaded words instead of starting the REPL */
+    if (meta)
+        return onward_meta(meta, roots, files);
+#endif
     printf("Memory Usage: %zd / %zd\n", here - (value_t)Word_Buffer, sizeof(Word_Buffer));
+    /* Serve requests instead of starting the REPL if asked to */
+    if (serve && (prefork > 0))
+        return server_prefork(serve, prefork, (pool > 0) ? pool : 1);
+    else if (serve)
+        return server_run(serve, (pool > 0) ? pool : 1);
     /* Start the REPL */
     parse(stdin);
+    /* Report what the session used so the buffers can be sized */
+    printf("\nMemory Usage: %zd / %zd\n", here - (value_t)Word_Buffer, sizeof(Word_Buffer));
+    stats_code();
     return 0;
 }
+#endif
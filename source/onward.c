@@ -1,10 +1,151 @@
 #include "onward.h"
-#include "onward_sys.h"
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <assert.h>
+#include <time.h>
+#include <pthread.h>
 
 static value_t char_oneof(char ch, char* chs);
+static void umul_wide(uvalue_t lval, uvalue_t rval, uvalue_t* hi, uvalue_t* lo);
+static void mul_wide(value_t lval, value_t rval, uvalue_t* hi, uvalue_t* lo);
+static value_t udiv_wide(uvalue_t hi, uvalue_t lo, uvalue_t div, uvalue_t* quot, uvalue_t* rem);
+static value_t muldiv_wide(value_t lval, value_t rval, value_t div, value_t* quot, value_t* rem);
+static word_t const* find_word(char const* name);
+static value_t task_can_switch(void);
+static task_t* task_current(void);
+static void task_switch(task_t* next);
+static void task_remove(void);
+static value_t name_hash(char const* name);
+static value_t throw_resume(value_t start);
+static void interp_word(void);
+static void dict_rollback(value_t to_here, value_t to_latest);
+static void catch_exit_code(void);
+static value_t token_small(value_t val);
+static value_t token_literal(uvalue_t tok);
+static value_t token_offset(uvalue_t off);
+static void token_enter_code(void);
+static void token_run(void);
+static uint16_t token_lookup(word_t const* word);
+static value_t token_emit(value_t const* code, value_t count, value_t const* at, uint16_t* toks);
+static value_t token_store(word_t* word, value_t count, uint16_t const* toks, value_t size);
+static value_t* as_cells(value_t count);
+static value_t operand_fetch(void);
+static value_t local_find(char const* name);
+static value_t limit_exceeded(void);
+static int64_t limit_clock(void);
+static value_t dict_fits(value_t size);
+static value_t dict_room(value_t size);
+static value_t scan_word(onward_scan_t* scan);
+static int read_char(void);
+static void write_char(value_t ch);
+static void write_str(char const* str);
+
+/* Statistics are counted unless NO_STATS is defined. The registers that hold
+ * them are always defined and read 0 when they are not counted. */
+#ifndef NO_STATS
+    #define STAT_ADD(reg, val) ((reg) += (val))
+    #define STAT_MAX(reg, val) do { if ((val) > (reg)) (reg) = (val); } while (0)
+#else
+    #define STAT_ADD(reg, val) ((void)0)
+    #define STAT_MAX(reg, val) ((void)0)
+#endif
+
+/* The number of name buckets used to invalidate cached word handles */
+#define NAME_EPOCH_COUNT 64u
+
+/* Generation counters incremented when a name in the bucket is defined. They
+ * are shared by every instance so they are only updated atomically. */
+static value_t Name_Epochs[NAME_EPOCH_COUNT];
+
+/* Input and output state of the active interpreter instance */
+static ONWARD_TLS char const* Input;
+static ONWARD_TLS char const* Input_End;
+static ONWARD_TLS char* Output;
+static ONWARD_TLS char* Output_End;
+static ONWARD_TLS value_t (*Fetch_Char)(void);
+static ONWARD_TLS void (*Emit_Char)(value_t);
+
+/* The last word read from the input */
+static ONWARD_TLS char Word_Name[WORD_NAME_SZ];
+
+/* The words scanned ahead of the interpreter by onward_eval_scanned */
+static ONWARD_TLS onward_scan_fn_t Scan_Next;
+static ONWARD_TLS void* Scan_Ctx;
+
+/* Whether primitives are currently being dispatched by the interpreter loop */
+static ONWARD_TLS value_t Inner_Active = 0;
+
+/* The number of interpreter loops running on the C stack */
+static ONWARD_TLS value_t Exec_Depth = 0;
+
+/* The error code being thrown while interpreter loops unwind to a catch */
+static ONWARD_TLS value_t Throw_Code = 0;
+
+/* The innermost point on the C stack that a thrown error unwinds to */
+static ONWARD_TLS onward_frame_t* Throw_Frame = 0u;
+
+/* Instructions that a word executed by catch returns to when it completes */
+static const word_t Catch_Exit_Word = { 0u, F_PRIMITIVE_MSK, "(catch)", (value_t*)catch_exit_code };
+static const value_t Catch_Exit[] = { (value_t)&Catch_Exit_Word };
+
+/* Whether a backward branch or call exceeds the limits of the evaluation. The
+ * limits are only checked when one of them is set. */
+#define LIMIT_EXCEEDED() (((Limit_Fuel >= 0) || Limit_Deadline) && limit_exceeded())
+
+/* The number of checks of the limits between reads of the clock */
+#define LIMIT_CLOCK_CHECKS (256)
+
+/* The number of checks left before the clock is read for the deadline */
+static ONWARD_TLS value_t Clock_Checks = 0;
+
+/* The limits of the evaluation in progress, set by onward_limit(). They are
+ * not registers so that the code being limited cannot change them. The
+ * deadline is in nanoseconds of the monotonic clock, which overflows a cell
+ * narrower than 64 bits. */
+static ONWARD_TLS value_t Limit_Fuel = -1;
+static ONWARD_TLS int64_t Limit_Deadline = 0;
+static ONWARD_TLS value_t Limit_Base = 0;
+static ONWARD_TLS value_t Limit_End = 0;
+
+/* The largest number of cells in each stack of a task, keeping the size of
+ * the task well within a cell */
+#define TASK_MAX_CELLS ((((uvalue_t)1u << (CELL_BITS - 2u)) - sizeof(task_t)) / (2u * sizeof(value_t)))
+
+/* The maximum number of locals a word can declare */
+#define LOCALS_MAX (16u)
+
+/* The names of the locals declared by the word being compiled */
+static ONWARD_TLS char Local_Names[LOCALS_MAX][WORD_NAME_SZ];
+static ONWARD_TLS value_t Local_Count = 0;
+
+/* The first instruction of a token threaded word, it runs the token stream
+ * that follows it and then returns to the caller */
+static const word_t Token_Enter_Word = { 0u, F_PRIMITIVE_MSK, "(tokens)", (value_t*)token_enter_code };
+
+/* The word of every token. The reserved tokens map to the words they stand
+ * in for so they can be traced. Tokens are shared by every thread and are
+ * never reassigned, new ones are assigned under Token_Lock and published by
+ * the release of Token_Count. */
+static word_t const* Token_Words[TOKEN_COUNT] = { 0u, &lit, &br, &zbr, &tick };
+static value_t Token_Count = TOKEN_FIRST;
+static pthread_mutex_t Token_Lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Open addressed map from the address of a word to its token, 0 if empty */
+#define TOKEN_INDEX_BITS (16u)
+#define TOKEN_INDEX_SIZE ((uvalue_t)1u << TOKEN_INDEX_BITS)
+static uint16_t Token_Index[TOKEN_INDEX_SIZE];
+
+/* The number of token interpreter loops running on the C stack */
+static ONWARD_TLS value_t Token_Depth = 0;
+
+/* The original task of the thread and the task that is currently running. The
+ * schedule is set up by task_current() when it is first needed. */
+static ONWARD_TLS task_t Main_Task;
+static ONWARD_TLS task_t* Current_Task = 0u;
+
+/* Storage for the state of the host when no instance has been entered */
+static ONWARD_TLS onward_vm_t Default_VM;
+static ONWARD_TLS onward_vm_t* Current_VM = 0u;
 
 /** Version number of the implementation */
 defconst("VERSION", VERSION, 0, 0u);
@@ -25,143 +166,135 @@ defconst("F_HIDDEN", F_HIDDEN, F_HIDDEN_MSK, &F_PRIMITIVE_word);
 defconst("F_IMMEDIATE", F_IMMEDIATE, F_IMMEDIATE_MSK, &F_HIDDEN_word);
 
 /** Counter containing the address of the next word to execute */
-defvar("pc", pc, 0, &F_IMMEDIATE_word);
+defreg("pc", pc, 0, &F_IMMEDIATE_word);
 
 /** The address of the base of the argument stack */
-defvar("asb", asb, (value_t)Argument_Stack-1, &pc_word);
+defreg("asb", asb, 0, &pc_word);
 
 /** The size of the argument stack in bytes */
-defvar("assz", assz, ARG_STACK_SZ, &asb_word);
+defreg("assz", assz, 0, &asb_word);
 
 /** The address of the top of the argument stack */
-defvar("asp", asp, (value_t)Argument_Stack-1, &assz_word);
+defreg("asp", asp, 0, &assz_word);
 
 /** The address of the base of the return stack */
-defvar("rsb", rsb, (value_t)Return_Stack-1, &asp_word);
+defreg("rsb", rsb, 0, &asp_word);
 
 /** The size of the return stack in bytes */
-defvar("rssz", rssz, RET_STACK_SZ, &rsb_word);
+defreg("rssz", rssz, 0, &rsb_word);
 
 /** The address of the top of the return stack */
-defvar("rsp", rsp, (value_t)Return_Stack-1, &rssz_word);
+defreg("rsp", rsp, 0, &rssz_word);
 
 /** Base of the user-defined word buffer */
-defvar("hbase", hbase, (value_t)Word_Buffer, &rsp_word);
+defreg("hbase", hbase, 0, &rsp_word);
 
 /** The address where the next word or instruction will be written */
-defvar("here", here, (value_t)Word_Buffer, &hbase_word);
+defreg("here", here, 0, &hbase_word);
 
 /** Size of the user-defined word buffer */
-defvar("hsize", hsize, WORD_BUF_SZ, &here_word);
+defreg("hsize", hsize, 0, &here_word);
 
 /** The last generated error code */
-defvar("errcode", errcode, 0, &hsize_word);
+defreg("errcode", errcode, 0, &hsize_word);
 
 /** Address of the most recently defined word */
-defvar("latest", latest, (value_t)LATEST_BUILTIN, &errcode_word);
+defreg("latest", latest, (value_t)LATEST_BUILTIN, &errcode_word);
 
 /** The current state of the interpreter */
-defvar("state", state, 0, &latest_word);
+defreg("state", state, 0, &latest_word);
+
+/** Base address of the instruction trace ring buffer or 0 if disabled */
+defreg("trbuf", trbuf, 0, &state_word);
+
+/** The number of entries in the instruction trace ring buffer */
+defreg("trsz", trsz, 0, &trbuf_word);
+
+/** The total number of instructions recorded in the trace ring buffer */
+defreg("trpos", trpos, 0, &trsz_word);
+
+/** Address of the innermost catch frame on the return stack or 0 if none */
+defreg("handler", handler, 0, &trpos_word);
+
+/** Compile new definitions to token threaded code if non-zero */
+defreg("tokens", tokens, 0, &handler_word);
+
+/** The number of instructions dispatched by the interpreter loops */
+defreg("dispatches", stat_dispatches, 0, &tokens_word);
+
+/** The number of primitives called by the interpreter loops */
+defreg("prim-calls", stat_prim_calls, 0, &stat_dispatches_word);
+
+/** The number of colon definitions called by the interpreter loops */
+defreg("colon-calls", stat_colon_calls, 0, &stat_prim_calls_word);
+
+/** The number of dictionary searches */
+defreg("finds", stat_finds, 0, &stat_colon_calls_word);
+
+/** The total number of words visited by dictionary searches */
+defreg("find-steps", stat_find_steps, 0, &stat_finds_word);
+
+/** The number of bytes of names, headers, and instructions compiled */
+defreg("compiled", stat_compiled, 0, &stat_find_steps_word);
+
+/** The largest number of cells held by the argument stack */
+defreg("as-max", stat_as_max, 0, &stat_compiled_word);
+
+/** The largest number of cells held by the return stack */
+defreg("rs-max", stat_rs_max, 0, &stat_as_max_word);
+
+/** The largest number of bytes used in the dictionary */
+defreg("dict-max", stat_dict_max, 0, &stat_rs_max_word);
 
 /** Read a character from the default input source */
-defcode("key", key, &state_word, 0u) {
-    onward_aspush(fetch_char());
+defcode("key", key, &stat_dict_max_word, 0u) {
+    onward_aspush(read_char());
 }
 
-/** Read a character from the default input source */
+/** Write a character to the default output destination */
 defcode("emit", emit, &key, 0u) {
-    emit_char((int)onward_aspop());
+    write_char(onward_aspop());
 }
 
 /** Drop the rest of the current line from the default input source */
 defcode("\\", dropline, &emit, F_IMMEDIATE_MSK) {
     int curr;
     do {
-        ((primitive_t)key.code)();
-        curr = (int)onward_aspop();
+        curr = read_char();
     } while(((char)curr != '\n') && (curr != EOF));
 }
 
 /** Fetches the next word from the input string */
 defcode("word", word, &dropline, 0u) {
-    static char buffer[32u];
-    char* str = buffer;
+    char* str = Word_Name;
     int curr;
     /* Skip any whitespace */
     do {
-        key_code();
-        curr = (int)onward_aspop();
+        curr = read_char();
     } while (char_oneof((char)curr, " \t\r\n"));
-    /* Copy characters into the buffer */
+    /* Copy characters into the buffer, dropping those that do not fit */
     while(((int)curr != EOF) && !char_oneof((char)curr, " \t\r\n")) {
-        *str++ = (char)curr;
-        key_code();
-        curr = (int)onward_aspop();
+        if (str < (Word_Name + sizeof(Word_Name) - 1u))
+            *str++ = (char)curr;
+        curr = read_char();
     }
     /* Terminate the string */
     *str = '\0';
     /* Return the internal buffer */
-    onward_aspush((value_t)buffer);
+    onward_aspush((value_t)Word_Name);
 }
 
 /** Parses a string as a number literal */
 defcode("num", num, &word, 0u) {
     char* word = (char*)onward_aspop();
-    char* start = word;
-    value_t success = 0;
-    value_t value = 0;
-    int sign = 1;
-    int base = 10;
-    char c;
-    /* Detect the sign of the number */
-    if (*start == '-') {
-        sign = -1;
-        start++;
-    }
-
-    /* Detect the base of the number to parse */
-    if (*start == '0') {
-        start++;
-        switch (*(start++)) {
-            case 'b': base = 2;  break;
-            case 'o': base = 8;  break;
-            case 'd': base = 10; break;
-            case 'x': base = 16; break;
-            case '\0':
-                success = 1;
-                value = 0;
-            default:  base = -1; break;
-        }
-    }
-
-    /* Parse the number */
-    if (base > 1) {
-        for (c = *start++; c != '\0'; c= *start++) {
-            /* Get the digit value */
-            if ((c >= '0') && (c <= '9'))
-                c -= '0';
-            else if (((c >= 'a') && (c <= 'f')) || ((c >= 'A') && (c <= 'F')))
-                c -= (c >= 'A' && c <= 'Z') ? 'A' - 10 : 'a' - 10;
-            else
-                break;
-            /* Bail if the digit value is too high */
-            if (c >= base) break;
-            /* Update the accumulated value */
-            value = (value * base) + c;
-            success = 1;
-        }
-
-        /* Convert to the required sign */
-        value *= sign;
-    }
-
-    /* Push the results back on the stack */
-    success = (success && (*(start-1) == '\0'));
-    if (success)
+    value_t value;
+    if (onward_number(word, (value_t)strlen(word), &value)) {
         onward_aspush(value);
-    else
+        onward_aspush(1);
+    } else {
         onward_aspush((value_t)word);
-    onward_aspush(success);
+        onward_aspush(0);
+    }
 }
 
 /** Push the number pointed to by the program counter onto the argument stack */
@@ -171,48 +304,112 @@ defcode("lit", lit, &num, 0u) {
 
 /** Lookup a string in the dictionary */
 defcode("find", find, &lit, 0u) {
-    const word_t* curr = (const word_t*)latest;
-    char* name = (char*)onward_aspop();
-    while(curr) {
-        if (0 == strcmp(curr->name,name))
-            break;
-        curr = curr->link;
-    }
-    onward_aspush((value_t)curr);
+    onward_aspush((value_t)find_word((char const*)onward_aspop()));
 }
 
-/** Execute a word */
+/** Execute a word. Within the interpreter loop the word is dispatched from the
+ * loop rather than a nested one so that it can pause and be caught like a
+ * called word. Either way it completes before the next instruction runs. */
 defcode("exec", exec, &find, 0u) {
-    /* Load up the word to be executed, saving off the current state */
-    value_t start = rsp;
-    word_t* to_exec[] = { (word_t*)onward_aspop(), 0u };
-    onward_rspush(pc);
-    pc = (value_t)to_exec;
-    /* Loop through the instructions of the word until completion */
-    do {
-        word_t* current = (word_t*)( onward_pcfetch() );
-        /* If the current instruction is null then "return" */
-        if (0u == current) {
-            pc = (value_t)onward_rspop();
-        /* if the instruction is a primitive then execute the c function */
-        } else if (current->flags & F_PRIMITIVE_MSK) {
-            ((primitive_t)current->code)();
-        /* else "call" the word by pushing the current context on the stack
-         * and loading the instruction register */
-        } else {
+    word_t* word = (word_t*)onward_aspop();
+    /* If the interpreter loop is running then dispatch the word from it */
+    if (Inner_Active) {
+        if (word->flags & F_PRIMITIVE_MSK) {
+            ((primitive_t)word->code)();
+        } else if (!LIMIT_EXCEEDED()) {
+            /* pc is set first so an overflow of the return stack clears it */
+            value_t ret = pc;
+            pc = (value_t)word->code;
+            onward_rspush(ret);
+        }
+    /* Otherwise run the word to completion unless an error is unwinding */
+    } else if (!Throw_Code) {
+        value_t start = rsp;
+        word_t* to_exec[] = { word, 0u };
+        onward_frame_t frame;
+        Exec_Depth++;
+        onward_frame_push(&frame);
+        /* Load up the word to be executed, saving off the current state. A
+         * thrown error clears pc and jumps back here, it is only checked for
+         * once the loop stops. */
+        if (0 == setjmp(frame.jump)) {
             onward_rspush(pc);
-            pc = (value_t)current->code;
+            pc = (value_t)to_exec;
         }
-    } while(pc && rsp != start);
+        Inner_Active = 1;
+        /* Loop through the instructions of the word until completion */
+        do { while (pc && (rsp != start)) {
+            word_t* current = (word_t*)( onward_pcfetch() );
+            STAT_ADD(stat_dispatches, 1);
+            /* Record the instruction in the trace buffer if tracing is enabled */
+            if (trbuf) {
+                trace_t* entry = ((trace_t*)trbuf) + (trpos++ & (trsz - 1));
+                entry->pc   = pc - sizeof(value_t);
+                entry->word = current;
+                entry->tos  = (asp > asb) ? *((value_t*)asp) : 0;
+            }
+            /* If the current instruction is null then "return" */
+            if (0u == current) {
+                pc = (value_t)onward_rspop();
+            /* if the instruction is a primitive then execute the c function */
+            } else if (current->flags & F_PRIMITIVE_MSK) {
+                STAT_ADD(stat_prim_calls, 1);
+                ((primitive_t)current->code)();
+            /* else "call" the word by pushing the current context on the stack
+             * and loading the instruction register, unless that exceeds the
+             * limits of the evaluation */
+            } else if (!LIMIT_EXCEEDED()) {
+                value_t ret = pc;
+                STAT_ADD(stat_colon_calls, 1);
+                pc = (value_t)current->code;
+                onward_rspush(ret);
+            }
+        } } while (throw_resume(start));
+        onward_frame_pop(&frame);
+        Exec_Depth--;
+        Inner_Active = 0;
+        /* An error that was not caught has now been unwound back to the host */
+        if (0 == Exec_Depth)
+            Throw_Code = 0;
+    }
+}
+
+/** Allocate a handle that caches the word with the given name */
+defcode("handle", handle, &exec, 0u) {
+    char const* name = (char const*)onward_aspop();
+    size_t str_size  = strlen(name) + 1;
+    size_t new_size  = str_size + ((sizeof(value_t) - (str_size % sizeof(value_t))) % sizeof(value_t));
+    onward_xt_t* xt  = (onward_xt_t*)onward_allot((value_t)(sizeof(onward_xt_t) + new_size));
+    if (!xt)
+        return;
+    onward_xt_init(xt, memcpy((void*)(xt + 1), name, str_size));
+    (void)onward_xt_resolve(xt);
+    onward_aspush((value_t)xt);
+}
+
+/** Lookup the word referenced by a handle, using the cached word if valid */
+defcode("hfind", hfind, &handle, 0u) {
+    onward_aspush((value_t)onward_xt_resolve((onward_xt_t*)onward_aspop()));
+}
+
+/** Execute the word referenced by a handle */
+defcode("hexec", hexec, &hfind, 0u) {
+    hfind_code();
+    exec_code();
 }
 
 /** Create a new word definition with default attributes */
-defcode("create", create, &exec, 0u) {
+defcode("create", create, &hexec, 0u) {
     /* Pop the arguments into temporary variables */
     char* name = (char*)onward_aspop();
-    /* Copy the name to a more permanent location */
     size_t str_size = strlen(name) + 1;
     size_t new_size = str_size + ((sizeof(value_t) - (str_size % sizeof(value_t))) % sizeof(value_t));
+    /* Make sure the name, header, and code terminator fit */
+    if (!dict_room((value_t)(new_size + sizeof(word_t) + sizeof(value_t))))
+        return;
+    /* Invalidate any handles that may now resolve to the new word */
+    (void)__atomic_fetch_add(&(Name_Epochs[name_hash(name)]), 1, __ATOMIC_RELEASE);
+    /* Copy the name to a more permanent location */
     name = memcpy((void*)here, name, str_size);
     here += new_size;
     /* Start populating the word definition */
@@ -224,17 +421,32 @@ defcode("create", create, &exec, 0u) {
     latest  = here;
     here   += sizeof(word_t);
     *((value_t*)here) = 0u;
+    /* Locals left by a definition that was abandoned do not carry over */
+    Local_Count = 0;
+    STAT_ADD(stat_compiled, (value_t)(new_size + sizeof(word_t)));
+    STAT_MAX(stat_dict_max, here - hbase);
 }
 
 /** Append a word to the latest word definition */
 defcode(",", comma, &create, 0u) {
+    if (!dict_room(2 * sizeof(value_t)))
+        return;
     *((value_t*)here)  = onward_aspop();
     here              += sizeof(value_t);
     *((value_t*)here)  = 0u;
+    STAT_ADD(stat_compiled, sizeof(value_t));
+    STAT_MAX(stat_dict_max, here - hbase);
+}
+
+/** Reserve the given number of bytes at here and push their address */
+defcode("allot", allot, &comma, 0u) {
+    value_t addr = onward_allot(onward_aspop());
+    if (addr)
+        onward_aspush(addr);
 }
 
 /** Set the interpreter mode to "interpret" */
-defcode("[", lbrack, &comma, F_IMMEDIATE_MSK) {
+defcode("[", lbrack, &allot, F_IMMEDIATE_MSK) {
     state = 0;
 }
 
@@ -251,79 +463,249 @@ defword(":", colon, &rbrack, 0u) {
 /** Start a new word definition */
 defcode(";", semicolon, &colon, F_IMMEDIATE_MSK) {
     ((word_t*)latest)->flags &= ~F_HIDDEN;
+    /* Discard the locals frame before returning */
+    if (Local_Count) {
+        onward_aspush(W(unlocals));
+        comma_code();
+        onward_aspush(Local_Count);
+        comma_code();
+        Local_Count = 0;
+    }
     here += sizeof(value_t);
+    STAT_MAX(stat_dict_max, here - hbase);
     state = 0;
+    if (tokens)
+        (void)onward_tokenize((word_t*)latest);
 }
 
-/** Retrieve the next word to execute and put it on the stack */
+/** Retrieve the next word to execute and put it on the stack. When run from
+ * the interpreter there is no next word so it is looked up from the input. */
 defcode("'", tick, &semicolon, 0u) {
-    onward_aspush(onward_pcfetch());
+    if (*((value_t*)pc)) {
+        onward_aspush(onward_pcfetch());
+    } else {
+        word_code();
+        find_code();
+        if (!onward_aspeek(0))
+            onward_throw(ERR_UNKNOWN_WORD);
+    }
 }
 
 /** Branch unconditionally to the offset specified by the next instruction */
 defcode("br", br, &tick, 0u) {
-    pc += *((value_t*)pc);
+    value_t offset = *((value_t*)pc);
+    /* Backward branches are charged against the limits so loops are bounded */
+    if ((offset > 0) || !LIMIT_EXCEEDED())
+        pc += offset;
 }
 
 /** Branch to the offset specified by the next instruction if the top item on
  * the stack is 0 */
 defcode("0br", zbr, &br, 0u) {
-    if (!onward_aspop())
-        pc += *((value_t*)pc);
-    else
+    if (onward_aspop())
         pc += sizeof(intptr_t);
+    else if ((*((value_t*)pc) > 0) || !LIMIT_EXCEEDED())
+        pc += *((value_t*)pc);
 }
 
 /** Take the input string, tokenize it, and execute or compile each word */
 defcode("interp", interp, &zbr, 0u) {
-    /* Grab the next word of input */
-    word_code();
-    /* if we actually got anything */
-    if (strlen((char*)onward_aspeek(0)) > 0) {
-        /* Try to parse it as a number */
-        num_code();
-        /* If it's a number */
-        if (onward_aspop()) {
-            /* If we're compiling, then append the number to the word */
-            if (state == 1) {
-                onward_aspush((intptr_t)&lit);
-                comma_code();
-                comma_code();
-            }
-        /* otherwise, look it up */
-        } else {
-            char* name = (char*)onward_aspeek(0);
-            /* Lookup the word in the dictionary */
-            find_code();
-            /* If we found a definition execute it */
-            if (onward_aspeek(0)) {
-                /* If we are in immediate more or the word is immediate */
-                if((state == 0) || (((word_t*)onward_aspeek(0))->flags & F_IMMEDIATE))
-                {
-                    exec_code();
-                }
-                /* Otherwise, compile it! */
-                else
-                {
-                    comma_code();
-                }
-            /* Report an error */
-            } else {
-                errcode = ERR_UNKNOWN_WORD;
-                (void)onward_aspop();
-                printf("Unknown word: %s\n", name);
-            }
+    onward_frame_t frame;
+    /* A host calling interp directly gets a frame of its own so that an error
+     * stops the word instead of returning into it */
+    if (Throw_Frame) {
+        interp_word();
+    } else {
+        onward_frame_push(&frame);
+        if (0 == setjmp(frame.jump))
+            interp_word();
+        onward_frame_pop(&frame);
+    }
+}
+
+/** Interpret the string with the given address and length */
+defcode("evaluate", evaluate, &interp, 0u) {
+    value_t length = onward_aspop();
+    char const* source = (char const*)onward_aspop();
+    (void)onward_eval(source, length);
+}
+
+/** Execute a word and push 0 if it completes. If the word throws an error
+ * the stacks are restored to their depth before the word and the error code
+ * is pushed instead. */
+defcode("catch", _catch, &evaluate, 0u) {
+    /* A catch frame needs an interpreter loop that can be resumed */
+    if (!Inner_Active) {
+        onward_exec(&_catch);
+    } else {
+        value_t word = onward_aspop();
+        value_t ret  = pc;
+        pc = (value_t)Catch_Exit;
+        onward_rspush(ret);
+        onward_rspush(asp);
+        onward_rspush(Exec_Depth);
+        onward_rspush(handler);
+        if (!Throw_Code) {
+            handler = rsp;
+            onward_aspush(word);
+            exec_code();
         }
-    /* Otherwise, discard it */
+    }
+}
+
+/** Throw the error code on top of the stack to the innermost catch if it is
+ * not 0 */
+defcode("throw", _throw, &_catch, 0u) {
+    onward_throw(onward_aspop());
+}
+
+/** Restore here and latest to the given values, discarding every word defined
+ * since. Tasks allocated in the discarded space are removed from the
+ * schedule. */
+defcode("rollback", rollback, &_throw, 0u) {
+    value_t to_latest = onward_aspop();
+    value_t to_here   = onward_aspop();
+    dict_rollback(to_here, to_latest);
+}
+
+/** Create a word with the name given by the next word of input that discards
+ * itself and every word defined after it when executed */
+defcode("marker", marker, &rollback, 0u) {
+    value_t to_here   = here;
+    value_t to_latest = latest;
+    word_code();
+    create_code();
+    ((word_t*)latest)->flags &= ~F_HIDDEN;
+    onward_aspush(W(lit));
+    comma_code();
+    onward_aspush(to_here);
+    comma_code();
+    onward_aspush(W(lit));
+    comma_code();
+    onward_aspush(to_latest);
+    comma_code();
+    onward_aspush(W(rollback));
+    comma_code();
+    here += sizeof(value_t);
+    STAT_MAX(stat_dict_max, here - hbase);
+}
+
+/** Discard the word with the name given by the next word of input and every
+ * word defined after it */
+defcode("forget", forget, &marker, 0u) {
+    word_t* word;
+    word_code();
+    find_code();
+    word = (word_t*)onward_aspop();
+    /* Only words in the word buffer can be discarded */
+    if (word && ((value_t)word->name >= hbase) && ((value_t)word < (hbase + hsize)))
+        dict_rollback((value_t)word->name, (value_t)word->link);
+    else
+        onward_throw(ERR_UNKNOWN_WORD);
+}
+
+/** Convert a word to token threaded code, pushing 1 if it was converted or 0
+ * if it is a primitive, already converted, or cannot be encoded */
+defcode("tokenize", tokenize, &forget, 0u) {
+    onward_aspush(onward_tokenize((word_t*)onward_aspop()));
+}
+
+/* Local Variable Words
+ *****************************************************************************/
+/** Move the number of items given by the next instruction from the argument
+ * stack to a new locals frame on the return stack, keeping their order */
+defcode("(locals)", locals, &tokenize, 0u) {
+    value_t count = operand_fetch();
+    value_t* top  = as_cells(count);
+    if (top && ((rsp + (count * (value_t)sizeof(value_t))) > (rsb + rssz))) {
+        onward_throw(ERR_RET_STACK_OVRFLW);
+    } else if (top) {
+        memcpy((value_t*)rsp + 1, top - count + 1, (size_t)count * sizeof(value_t));
+        rsp += count * (value_t)sizeof(value_t);
+        asp -= count * (value_t)sizeof(value_t);
+        STAT_MAX(stat_rs_max, (rsp - rsb) / (value_t)sizeof(value_t));
+    }
+}
+
+/** Push the local that is the number of items given by the next instruction
+ * below the top of the return stack */
+defcode("(local@)", local_fetch, &locals, 0u) {
+    onward_aspush(((value_t*)rsp)[-operand_fetch()]);
+}
+
+/** Store the top item on the stack in the local that is the number of items
+ * given by the next instruction below the top of the return stack */
+defcode("(local!)", local_store, &local_fetch, 0u) {
+    value_t index = operand_fetch();
+    ((value_t*)rsp)[-index] = onward_aspop();
+}
+
+/** Discard the locals frame with the number of items given by the next
+ * instruction */
+defcode("(unlocals)", unlocals, &local_store, 0u) {
+    value_t count = operand_fetch();
+    if ((rsp - (count * (value_t)sizeof(value_t))) < rsb)
+        onward_throw(ERR_RET_STACK_UNDRFLW);
+    else
+        rsp -= count * (value_t)sizeof(value_t);
+}
+
+/** Declare the locals of the word being compiled. The names up to -- or } are
+ * initialized from the stack with the last name taking the top item, the
+ * names after -- are a comment. */
+defcode("{", lbrace, &unlocals, F_IMMEDIATE_MSK) {
+    value_t comment = 0, excess = 0, declared = Local_Count;
+    char const* name;
+    for (;;) {
+        word_code();
+        name = (char const*)onward_aspop();
+        if (!*name || !strcmp(name, "}"))
+            break;
+        else if (!strcmp(name, "--"))
+            comment = 1;
+        else if (!comment && !declared && (Local_Count < LOCALS_MAX))
+            strcpy(Local_Names[Local_Count++], name);
+        else if (!comment)
+            excess = 1;
+    }
+    if (declared) {
+        write_str("Locals already declared\n");
+        onward_throw(ERR_UNKNOWN_WORD);
+    } else if (excess) {
+        write_str("Too many locals\n");
+        onward_throw(ERR_RET_STACK_OVRFLW);
+    } else if (Local_Count) {
+        onward_aspush(W(locals));
+        comma_code();
+        onward_aspush(Local_Count);
+        comma_code();
+    }
+}
+
+/** Compile a store of the top item on the stack to the local named by the
+ * next word of input */
+defcode("to", to, &lbrace, F_IMMEDIATE_MSK) {
+    value_t index;
+    word_code();
+    index = local_find((char const*)onward_aspeek(0));
+    if (index < 0) {
+        write_str("Unknown local: ");
+        write_str((char const*)onward_aspop());
+        write_char('\n');
+        onward_throw(ERR_UNKNOWN_WORD);
     } else {
         (void)onward_aspop();
+        onward_aspush(W(local_store));
+        comma_code();
+        onward_aspush(index);
+        comma_code();
     }
 }
 
 /* Memory Access Words
  *****************************************************************************/
 /** Fetch the value at the given address and place it on the stack */
-defcode("@", fetch, &interp, 0u) {
+defcode("@", fetch, &to, 0u) {
     onward_aspush( *((value_t*)onward_aspop()) );
 }
 
@@ -378,10 +760,12 @@ defcode("drop", drop, &block_copy, 0u) {
 
 /* Swaps the order of the top two items on the stack */
 defcode("swap", swap, &drop, 0u) {
-    value_t temp1 = onward_aspop();
-    value_t temp2 = onward_aspop();
-    onward_aspush(temp1);
-    onward_aspush(temp2);
+    value_t* top = as_cells(2);
+    if (top) {
+        value_t temp = top[0];
+        top[0]  = top[-1];
+        top[-1] = temp;
+    }
 }
 
 /* Duplicates the top item of the stack */
@@ -402,29 +786,83 @@ defcode("over", over, &dup_if, 0u) {
 /* Rotate the top three items such that the second item becomes the first and
  * the first item becomes the third */
 defcode("rot", rot, &over, 0u) {
-    value_t temp1 = onward_aspop();
-    value_t temp2 = onward_aspop();
-    value_t temp3 = onward_aspop();
-    onward_aspush(temp1);
-    onward_aspush(temp3);
-    onward_aspush(temp2);
+    value_t* top = as_cells(3);
+    if (top) {
+        value_t temp = top[0];
+        top[0]  = top[-1];
+        top[-1] = top[-2];
+        top[-2] = temp;
+    }
 }
 
 /* Rotate the top three items such that the third item becomes the first and
  * the first item becomes the second */
 defcode("-rot", nrot, &rot, 0u) {
-    value_t temp1 = onward_aspop();
-    value_t temp2 = onward_aspop();
-    value_t temp3 = onward_aspop();
-    onward_aspush(temp2);
-    onward_aspush(temp1);
-    onward_aspush(temp3);
+    value_t* top = as_cells(3);
+    if (top) {
+        value_t temp = top[-2];
+        top[-2] = top[-1];
+        top[-1] = top[0];
+        top[0]  = temp;
+    }
+}
+
+/* Copy the item the given number of items below the top of the stack, 0 is the
+ * top item */
+defcode("pick", pick, &nrot, 0u) {
+    value_t index = onward_aspop();
+    if (index < 0)
+        onward_throw(ERR_ARG_STACK_UNDRFLW);
+    else
+        onward_aspush(onward_aspeek(-index));
+}
+
+/* Move the item the given number of items below the top of the stack to the
+ * top, shifting the items above it down */
+defcode("roll", roll, &pick, 0u) {
+    value_t index = onward_aspop();
+    value_t* top  = (index < 0) ? NULL : as_cells(index + 1);
+    if (index < 0) {
+        onward_throw(ERR_ARG_STACK_UNDRFLW);
+    } else if (top) {
+        value_t temp = top[-index];
+        memmove(top - index, top - index + 1, (size_t)index * sizeof(value_t));
+        top[0] = temp;
+    }
+}
+
+/* Duplicates the top two items of the stack */
+defcode("2dup", two_dup, &roll, 0u) {
+    value_t* top = as_cells(2);
+    if (top) {
+        value_t second = top[-1];
+        onward_aspush(second);
+        onward_aspush(top[0]);
+    }
+}
+
+/* Swaps the order of the top two pairs of items on the stack */
+defcode("2swap", two_swap, &two_dup, 0u) {
+    value_t* top = as_cells(4);
+    if (top) {
+        value_t temp1 = top[0], temp2 = top[-1];
+        top[0]  = top[-2];
+        top[-1] = top[-3];
+        top[-2] = temp1;
+        top[-3] = temp2;
+    }
+}
+
+/* Discards the top two items on the stack */
+defcode("2drop", two_drop, &two_swap, 0u) {
+    if (as_cells(2))
+        asp -= 2 * sizeof(value_t);
 }
 
 /* Arithmetic Words
  *****************************************************************************/
 /** Add the top two items on the stack */
-defcode("+", add, &nrot, 0u) {
+defcode("+", add, &two_drop, 0u) {
     value_t rval = onward_aspop();
     value_t lval = onward_aspop();
     onward_aspush(lval + rval);
@@ -530,8 +968,231 @@ defcode("~", bnot, &bxor, 0u) {
     onward_aspush(~onward_aspop());
 }
 
+/* Double-Cell Arithmetic Words
+ *****************************************************************************/
+/** Multiply the top two items as unsigned values giving a double-cell product
+ * with the high cell on top */
+defcode("um*", umul, &bnot, 0u) {
+    uvalue_t hi, lo;
+    uvalue_t rval = (uvalue_t)onward_aspop();
+    uvalue_t lval = (uvalue_t)onward_aspop();
+    umul_wide(lval, rval, &hi, &lo);
+    onward_aspush((value_t)lo);
+    onward_aspush((value_t)hi);
+}
+
+/** Multiply the top two items giving a signed double-cell product with the
+ * high cell on top */
+defcode("m*", mmul, &umul, 0u) {
+    uvalue_t hi, lo;
+    value_t rval = onward_aspop();
+    value_t lval = onward_aspop();
+    mul_wide(lval, rval, &hi, &lo);
+    onward_aspush((value_t)lo);
+    onward_aspush((value_t)hi);
+}
+
+/** Divide an unsigned double-cell value by the top item giving the remainder
+ * and the quotient on top. Throws if the divisor is zero or the quotient does
+ * not fit in a cell. */
+defcode("um/mod", umdivmod, &mmul, 0u) {
+    uvalue_t rem, quot;
+    uvalue_t div = (uvalue_t)onward_aspop();
+    uvalue_t hi  = (uvalue_t)onward_aspop();
+    uvalue_t lo  = (uvalue_t)onward_aspop();
+    if (!udiv_wide(hi, lo, div, &quot, &rem)) {
+        onward_throw(ERR_BAD_DIVIDE);
+        return;
+    }
+    onward_aspush((value_t)rem);
+    onward_aspush((value_t)quot);
+}
+
+/** Multiply the second and third items and divide the double-cell product by
+ * the top item giving the remainder and the quotient on top. Throws if the
+ * divisor is zero or the quotient does not fit in a cell. */
+defcode("*/mod", muldivmod, &umdivmod, 0u) {
+    value_t rem, quot;
+    value_t div  = onward_aspop();
+    value_t rval = onward_aspop();
+    value_t lval = onward_aspop();
+    if (!muldiv_wide(lval, rval, div, &quot, &rem)) {
+        onward_throw(ERR_BAD_DIVIDE);
+        return;
+    }
+    onward_aspush(rem);
+    onward_aspush(quot);
+}
+
+/** Multiply the second and third items and divide the double-cell product by
+ * the top item giving the quotient. Throws if the divisor is zero or the
+ * quotient does not fit in a cell. */
+defcode("*/", muldiv, &muldivmod, 0u) {
+    value_t rem, quot;
+    value_t div  = onward_aspop();
+    value_t rval = onward_aspop();
+    value_t lval = onward_aspop();
+    if (!muldiv_wide(lval, rval, div, &quot, &rem)) {
+        onward_throw(ERR_BAD_DIVIDE);
+        return;
+    }
+    onward_aspush(quot);
+}
+
+/* Multitasking Words
+ *****************************************************************************/
+/** Create a task with stacks of the given number of cells that executes the
+ * given word. The task runs when the current task pauses. */
+defcode("spawn", spawn, &muldiv, 0u) {
+    value_t cells = onward_aspop();
+    word_t* word  = (word_t*)onward_aspop();
+    task_t* task;
+    value_t* stack;
+    if ((cells <= 0) || ((uvalue_t)cells > TASK_MAX_CELLS)) {
+        onward_throw(ERR_BAD_SIZE);
+        return;
+    }
+    task = (task_t*)onward_allot((value_t)(sizeof(task_t) + (2 * cells * sizeof(value_t))));
+    if (!task)
+        return;
+    stack = (value_t*)(task + 1);
+    task->code[0]  = (value_t)word;
+    task->code[1]  = (value_t)&stop;
+    task->code[2]  = 0u;
+    task->pc       = (value_t)task->code;
+    task->asb      = (value_t)(stack - 1);
+    task->assz     = cells * sizeof(value_t);
+    task->asp      = task->asb;
+    task->rsb      = (value_t)(stack + cells - 1);
+    task->rssz     = cells * sizeof(value_t);
+    task->rsp      = task->rsb;
+    task->handler  = 0;
+    task->depth    = 0;
+    /* Schedule the task to run after the current one */
+    task->next = task_current()->next;
+    Current_Task->next = task;
+    onward_aspush((value_t)task);
+}
+
+/** Switch to the next task that is ready to run */
+defcode("pause", _pause, &spawn, 0u) {
+    if (task_can_switch())
+        task_switch(task_current()->next);
+}
+
+/** Terminate the current task and switch to the next one */
+defcode("stop", stop, &_pause, 0u) {
+    if ((task_current() != &Main_Task) && task_can_switch())
+        task_remove();
+}
+
+/** Push the number of tasks that are scheduled besides the current one */
+defcode("tasks", tasks, &stop, 0u) {
+    value_t count = 0;
+    task_t* task  = task_current();
+    while (task->next != Current_Task) {
+        count++;
+        task = task->next;
+    }
+    onward_aspush(count);
+}
+
+/* Statistics Words
+ *****************************************************************************/
+/** Print the statistics counted by the interpreter */
+defcode("stats", stats, &tasks, 0u) {
+    char buf[128];
+    sprintf(buf, "dispatches:\t%zd\n", (intptr_t)stat_dispatches);
+    write_str(buf);
+    sprintf(buf, "prim-calls:\t%zd\n", (intptr_t)stat_prim_calls);
+    write_str(buf);
+    sprintf(buf, "colon-calls:\t%zd\n", (intptr_t)stat_colon_calls);
+    write_str(buf);
+    sprintf(buf, "finds:\t\t%zd (%.1f words per find)\n", (intptr_t)stat_finds,
+            stat_finds ? ((double)stat_find_steps / (double)stat_finds) : 0.0);
+    write_str(buf);
+    sprintf(buf, "compiled:\t%zd bytes\n", (intptr_t)stat_compiled);
+    write_str(buf);
+    sprintf(buf, "as-max:\t\t%zd / %zd cells\n", (intptr_t)stat_as_max,
+            (intptr_t)(assz / (value_t)sizeof(value_t)));
+    write_str(buf);
+    sprintf(buf, "rs-max:\t\t%zd / %zd cells\n", (intptr_t)stat_rs_max,
+            (intptr_t)(rssz / (value_t)sizeof(value_t)));
+    write_str(buf);
+    sprintf(buf, "dict-max:\t%zd / %zd bytes\n", (intptr_t)stat_dict_max, (intptr_t)hsize);
+    write_str(buf);
+}
+
 /* Helper C Functions
  *****************************************************************************/
+/* A spawned task may only switch at the loop depth it was resumed in so that
+ * it never leaves an interpreter loop of its own on the C stack */
+static value_t task_can_switch(void) {
+    /* The token interpreter loop cannot be resumed from another loop */
+    if (Token_Depth)
+        return 0;
+    return ((task_current() == &Main_Task) || (Current_Task->depth == Exec_Depth));
+}
+
+static task_t* task_current(void) {
+    if (!Current_Task) {
+        Main_Task.next = &Main_Task;
+        Current_Task   = &Main_Task;
+    }
+    return Current_Task;
+}
+
+/* Remove the current task from the schedule and switch to the next one */
+static void task_remove(void) {
+    task_t* prev = Current_Task;
+    while (prev->next != Current_Task)
+        prev = prev->next;
+    prev->next = Current_Task->next;
+    task_switch(Current_Task->next);
+}
+
+static void task_switch(task_t* next) {
+    task_t* curr  = Current_Task;
+    curr->pc      = pc;
+    curr->asb     = asb;
+    curr->assz    = assz;
+    curr->asp     = asp;
+    curr->rsb     = rsb;
+    curr->rssz    = rssz;
+    curr->rsp     = rsp;
+    curr->handler = handler;
+    pc            = next->pc;
+    asb           = next->asb;
+    assz          = next->assz;
+    asp           = next->asp;
+    rsb           = next->rsb;
+    rssz          = next->rssz;
+    rsp           = next->rsp;
+    handler       = next->handler;
+    next->depth   = Exec_Depth;
+    Current_Task  = next;
+}
+
+static void dict_rollback(value_t to_here, value_t to_latest) {
+    task_t* task = task_current();
+    value_t i;
+    if ((to_here < hbase) || (to_here > here))
+        return;
+    /* Unschedule tasks whose memory is being discarded */
+    while (task->next != Current_Task) {
+        value_t addr = (value_t)task->next;
+        if ((addr >= to_here) && (addr < here))
+            task->next = task->next->next;
+        else
+            task = task->next;
+    }
+    here   = to_here;
+    latest = to_latest;
+    /* Any handle may have resolved to a discarded word */
+    for (i = 0; i < (value_t)NAME_EPOCH_COUNT; i++)
+        (void)__atomic_fetch_add(&(Name_Epochs[i]), 1, __ATOMIC_RELEASE);
+}
+
 value_t onward_pcfetch(void) {
     value_t* reg = (value_t*)pc;
     value_t  val = *reg++;
@@ -539,38 +1200,627 @@ value_t onward_pcfetch(void) {
     return val;
 }
 
+value_t onward_number(char const* str, value_t len, value_t* val) {
+    char const* end = str + len;
+    value_t success = 0;
+    value_t value = 0;
+    int sign = 1;
+    int base = 10;
+    char c;
+    /* Detect the sign of the number */
+    if ((str < end) && (*str == '-')) {
+        sign = -1;
+        str++;
+    }
+
+    /* Detect the base of the number to parse */
+    if ((str < end) && (*str == '0')) {
+        str++;
+        if (str == end) {
+            *val = 0;
+            return 1;
+        }
+        switch (*(str++)) {
+            case 'b': base = 2;  break;
+            case 'o': base = 8;  break;
+            case 'd': base = 10; break;
+            case 'x': base = 16; break;
+            default:  base = -1; break;
+        }
+    }
+
+    /* Parse the number */
+    if (base > 1) {
+        for (; str < end; str++) {
+            /* Get the digit value */
+            c = *str;
+            if ((c >= '0') && (c <= '9'))
+                c -= '0';
+            else if (((c >= 'a') && (c <= 'f')) || ((c >= 'A') && (c <= 'F')))
+                c -= (c >= 'A' && c <= 'Z') ? 'A' - 10 : 'a' - 10;
+            else
+                break;
+            /* Bail if the digit value is too high */
+            if (c >= base) break;
+            /* Update the accumulated value */
+            value = (value * base) + c;
+            success = 1;
+        }
+
+        /* Convert to the required sign */
+        value *= sign;
+    }
+
+    /* The whole string must be part of the number */
+    success = (success && (str == end));
+    if (success)
+        *val = value;
+    return success;
+}
+
+value_t onward_operand(value_t instr) {
+    return ((instr == W(lit)) || (instr == W(br)) || (instr == W(zbr)) || (instr == W(tick)) ||
+            (instr == W(locals)) || (instr == W(local_fetch)) || (instr == W(local_store)) ||
+            (instr == W(unlocals)));
+}
+
 void onward_aspush(value_t val) {
+    if (asp >= (asb + assz)) {
+        onward_throw(ERR_ARG_STACK_OVRFLW);
+        return;
+    }
     asp += sizeof(value_t);
-    assert(asp <= (asb + ARG_STACK_SZ));
     *((value_t*)asp) = val;
+    STAT_MAX(stat_as_max, (asp - asb) / (value_t)sizeof(value_t));
 }
 
 value_t onward_aspeek(value_t val) {
     uintptr_t location = asp + (val * sizeof(value_t));
-    assert(location > asb);
+    if (location <= (uintptr_t)asb) {
+        onward_throw(ERR_ARG_STACK_UNDRFLW);
+        return 0;
+    }
     return *((value_t*)(location));
 }
 
 value_t onward_aspop(void) {
-    value_t val = *((value_t*)asp);
+    value_t val;
+    if (asp <= asb) {
+        onward_throw(ERR_ARG_STACK_UNDRFLW);
+        return 0;
+    }
+    val = *((value_t*)asp);
     asp -= sizeof(value_t);
-    assert(asp >= asb);
     return val;
 }
 
 void onward_rspush(value_t val) {
+    if (rsp >= (rsb + rssz)) {
+        onward_throw(ERR_RET_STACK_OVRFLW);
+        return;
+    }
     rsp += sizeof(value_t);
-    assert(rsp <= (rsb + RET_STACK_SZ));
     *((value_t*)rsp) = val;
+    STAT_MAX(stat_rs_max, (rsp - rsb) / (value_t)sizeof(value_t));
 }
 
 value_t onward_rspop(void) {
-    value_t val = *((value_t*)rsp);
+    value_t val;
+    if (rsp <= rsb) {
+        onward_throw(ERR_RET_STACK_UNDRFLW);
+        return 0;
+    }
+    val = *((value_t*)rsp);
     rsp -= sizeof(value_t);
-    assert(rsp >= rsb);
     return val;
 }
 
+void onward_throw(value_t code) {
+    if (code != ERR_NONE) {
+        /* Errors that nothing will catch are reported to the host */
+        if (!handler)
+            errcode = code;
+        /* Stop the running interpreter loops until one of them can resume */
+        if (Exec_Depth > 0) {
+            Throw_Code = code;
+            pc = 0;
+        }
+        /* The primitive that threw does not continue, the innermost loop or
+         * evaluation picks up from its frame instead */
+        if (Throw_Frame) {
+            Throw_Frame->code = code;
+            longjmp(Throw_Frame->jump, 1);
+        }
+    }
+}
+
+void onward_frame_push(onward_frame_t* frame) {
+    frame->prev = Throw_Frame;
+    frame->code = ERR_NONE;
+    Throw_Frame = frame;
+}
+
+void onward_frame_pop(onward_frame_t* frame) {
+    Throw_Frame = frame->prev;
+}
+
+void onward_trace_init(trace_t* buf, value_t count) {
+    /* Round the count down to a power of two so the index is a simple mask */
+    while (count & (count - 1))
+        count &= (count - 1);
+    trbuf = 0;
+    trpos = 0;
+    trsz  = count;
+    trbuf = (buf && count) ? (value_t)buf : 0;
+}
+
+trace_t const* onward_trace_entry(value_t age) {
+    trace_t const* entry = 0u;
+    if (trbuf && (age >= 0) && (age < trsz) && (age < trpos))
+        entry = ((trace_t*)trbuf) + ((trpos - 1 - age) & (trsz - 1));
+    return entry;
+}
+
+/* Embedding API
+ *****************************************************************************/
+static void vm_save(onward_vm_t* vm) {
+    vm->pc         = pc;
+    vm->asb        = asb;
+    vm->assz       = assz;
+    vm->asp        = asp;
+    vm->rsb        = rsb;
+    vm->rssz       = rssz;
+    vm->rsp        = rsp;
+    vm->hbase      = hbase;
+    vm->here       = here;
+    vm->hsize      = hsize;
+    vm->errcode    = errcode;
+    vm->latest     = latest;
+    vm->state      = state;
+    vm->handler    = handler;
+    vm->input      = Input;
+    vm->input_end  = Input_End;
+    vm->output     = Output;
+    vm->output_end = Output_End;
+    vm->fetch_char = Fetch_Char;
+    vm->emit_char  = Emit_Char;
+    vm->fuel       = Limit_Fuel;
+    vm->deadline   = Limit_Deadline;
+    vm->hlimit_base = Limit_Base;
+    vm->hlimit     = Limit_End;
+}
+
+static void vm_load(onward_vm_t const* vm) {
+    pc         = vm->pc;
+    asb        = vm->asb;
+    assz       = vm->assz;
+    asp        = vm->asp;
+    rsb        = vm->rsb;
+    rssz       = vm->rssz;
+    rsp        = vm->rsp;
+    hbase      = vm->hbase;
+    here       = vm->here;
+    hsize      = vm->hsize;
+    errcode    = vm->errcode;
+    latest     = vm->latest;
+    state      = vm->state;
+    handler    = vm->handler;
+    Input      = vm->input;
+    Input_End  = vm->input_end;
+    Output     = vm->output;
+    Output_End = vm->output_end;
+    Fetch_Char = vm->fetch_char;
+    Emit_Char  = vm->emit_char;
+    Limit_Fuel     = vm->fuel;
+    Limit_Deadline = vm->deadline;
+    Limit_Base     = vm->hlimit_base;
+    Limit_End      = vm->hlimit;
+}
+
+/* Apply the limits of the instance to the evaluation that is starting */
+static void vm_limits(onward_vm_t const* vm) {
+    onward_limit(vm->limit_fuel, vm->limit_ns, vm->limit_bytes);
+}
+
+/* Make the given instance active, returning the previously active instance */
+static onward_vm_t* vm_enter(onward_vm_t* vm) {
+    onward_vm_t* prev = (Current_VM ? Current_VM : &Default_VM);
+    if (vm != prev) {
+        vm_save(prev);
+        vm_load(vm);
+        Current_VM = vm;
+    }
+    return prev;
+}
+
+void onward_init(onward_init_t const* init) {
+    onward_vm_t vm;
+    onward_vm_init(&vm, init);
+    vm_load(&vm);
+}
+
+value_t onward_eval(char const* source, value_t length) {
+    /* Nested evaluation does not use the words scanned for the outer source */
+    (void)onward_eval_scanned(source, length, NULL, NULL);
+    return errcode;
+}
+
+char const* onward_eval_scanned(char const* source, value_t length, onward_scan_fn_t next, void* ctx) {
+    char const* input     = Input;
+    char const* input_end = Input_End;
+    char const* stop;
+    onward_scan_fn_t scan_next = Scan_Next;
+    void* scan_ctx        = Scan_Ctx;
+    value_t active        = Inner_Active;
+    onward_frame_t frame;
+    Input        = source;
+    Input_End    = source + length;
+    Scan_Next    = next;
+    Scan_Ctx     = ctx;
+    Inner_Active = 0;
+    errcode      = ERR_NONE;
+    /* An error thrown by a word stops the evaluation */
+    onward_frame_push(&frame);
+    if (0 == setjmp(frame.jump)) {
+        while ((Input < Input_End) && (errcode == ERR_NONE) && !Throw_Code)
+            interp_word();
+    }
+    onward_frame_pop(&frame);
+    stop         = Input;
+    Input        = input;
+    Input_End    = input_end;
+    Scan_Next    = scan_next;
+    Scan_Ctx     = scan_ctx;
+    Inner_Active = active;
+    return stop;
+}
+
+char const* onward_scan(char const* source, char const* end, onward_scan_t* scan) {
+    size_t len = 0;
+    /* Words are split the same way as by word, including truncation */
+    while ((source < end) && char_oneof(*source, " \t\r\n"))
+        source++;
+    if (source >= end)
+        return NULL;
+    scan->start = source;
+    for (; (source < end) && !char_oneof(*source, " \t\r\n"); source++) {
+        if (len < (sizeof(scan->name) - 1u))
+            scan->name[len++] = *source;
+    }
+    scan->name[len] = '\0';
+    scan->end       = source;
+    scan->number    = onward_number(scan->name, (value_t)len, &scan->value);
+    return source;
+}
+
+void onward_exec(word_t const* word) {
+    value_t active = Inner_Active;
+    onward_aspush((value_t)word);
+    Inner_Active = 0;
+    exec_code();
+    Inner_Active = active;
+}
+
+void onward_limit(value_t count, value_t timeout_ns, value_t bytes) {
+    Limit_Fuel     = count ? count : -1;
+    Limit_Deadline = timeout_ns ? (limit_clock() + (int64_t)timeout_ns) : 0;
+    Limit_Base     = here;
+    Limit_End      = bytes ? (here + bytes) : 0;
+    if (bytes && ((hbase + hsize) >= here) && (Limit_End > (hbase + hsize)))
+        Limit_End = hbase + hsize;
+}
+
+value_t onward_limited(void) {
+    return ((Limit_Fuel >= 0) || Limit_Deadline || Limit_End);
+}
+
+value_t onward_allot(value_t size) {
+    value_t addr = here;
+    if (!dict_room(size))
+        return 0;
+    here += size;
+    STAT_MAX(stat_dict_max, here - hbase);
+    return addr;
+}
+
+void onward_vm_init(onward_vm_t* vm, onward_init_t const* init) {
+    memset(vm, 0, sizeof(onward_vm_t));
+    vm->asb        = (value_t)(init->arg_stack - 1);
+    vm->assz       = init->arg_stack_sz;
+    vm->asp        = vm->asb;
+    vm->rsb        = (value_t)(init->ret_stack - 1);
+    vm->rssz       = init->ret_stack_sz;
+    vm->rsp        = vm->rsb;
+    vm->hbase      = (value_t)init->word_buf;
+    vm->here       = (value_t)init->word_buf;
+    vm->hsize      = init->word_buf_sz;
+    vm->latest     = (value_t)(init->latest ? init->latest : LATEST_BUILTIN);
+    vm->fetch_char = init->fetch_char;
+    vm->emit_char  = init->emit_char;
+    vm->fuel       = -1;
+}
+
+value_t onward_vm_eval(onward_vm_t* vm, char const* source, value_t length) {
+    onward_vm_t* prev = vm_enter(vm);
+    value_t result;
+    vm_limits(vm);
+    result = onward_eval(source, length);
+    (void)vm_enter(prev);
+    return result;
+}
+
+value_t onward_vm_call(onward_vm_t* vm, word_t const* word) {
+    onward_vm_t* prev = vm_enter(vm);
+    value_t result;
+    vm_limits(vm);
+    errcode = ERR_NONE;
+    onward_exec(word);
+    result = errcode;
+    (void)vm_enter(prev);
+    return result;
+}
+
+void onward_vm_limit(onward_vm_t* vm, value_t count, value_t timeout_ns, value_t bytes) {
+    vm->limit_fuel  = count;
+    vm->limit_ns    = timeout_ns;
+    vm->limit_bytes = bytes;
+    /* Limits left over from earlier evaluations no longer apply */
+    vm->fuel        = -1;
+    vm->deadline    = 0;
+    vm->hlimit_base = 0;
+    vm->hlimit      = 0;
+}
+
+void onward_vm_output(onward_vm_t* vm, char* buf, value_t size) {
+    /* Output goes back to emit_char without a buffer */
+    vm->output     = buf;
+    vm->output_end = buf ? (buf + size) : NULL;
+}
+
+word_t const* onward_vm_find(onward_vm_t* vm, char const* name) {
+    onward_vm_t* prev = vm_enter(vm);
+    word_t const* word;
+    onward_aspush((value_t)name);
+    find_code();
+    word = (word_t const*)onward_aspop();
+    (void)vm_enter(prev);
+    return word;
+}
+
+void onward_vm_push(onward_vm_t* vm, value_t val) {
+    onward_vm_t* prev = vm_enter(vm);
+    onward_aspush(val);
+    (void)vm_enter(prev);
+}
+
+value_t onward_vm_pop(onward_vm_t* vm) {
+    onward_vm_t* prev = vm_enter(vm);
+    value_t val = onward_aspop();
+    (void)vm_enter(prev);
+    return val;
+}
+
+value_t onward_vm_depth(onward_vm_t* vm) {
+    onward_vm_t* prev = vm_enter(vm);
+    value_t depth = (asp - asb) / (value_t)sizeof(value_t);
+    (void)vm_enter(prev);
+    return depth;
+}
+
+/* Word Handles
+ *****************************************************************************/
+void onward_xt_init(onward_xt_t* xt, char const* name) {
+    xt->name   = name;
+    xt->word   = 0u;
+    xt->latest = 0u;
+    xt->bucket = name_hash(name);
+    xt->epoch  = __atomic_load_n(&(Name_Epochs[xt->bucket]), __ATOMIC_ACQUIRE) - 1;
+}
+
+word_t const* onward_xt_resolve(onward_xt_t* xt) {
+    value_t epoch = __atomic_load_n(&(Name_Epochs[xt->bucket]), __ATOMIC_ACQUIRE);
+    word_t const* curr = (word_t const*)latest;
+    /* The cached word still holds if the dictionary has only grown by words
+     * with other names since it was resolved. That is not so when the handle
+     * is used by an instance with a different dictionary. */
+    if ((xt->epoch == epoch) && (curr != xt->latest)) {
+        while (curr && (curr != xt->latest) && strcmp(curr->name, xt->name))
+            curr = curr->link;
+        if (curr == xt->latest)
+            xt->latest = (word_t const*)latest;
+        else
+            xt->epoch = epoch - 1;
+    }
+    if (xt->epoch != epoch) {
+        xt->word   = find_word(xt->name);
+        xt->latest = (word_t const*)latest;
+        xt->epoch  = epoch;
+    }
+    return xt->word;
+}
+
+word_t const* onward_vm_resolve(onward_vm_t* vm, onward_xt_t* xt) {
+    onward_vm_t* prev = vm_enter(vm);
+    word_t const* word = onward_xt_resolve(xt);
+    (void)vm_enter(prev);
+    return word;
+}
+
+/* Token Threaded Code
+ *****************************************************************************/
+value_t onward_tokenize(word_t* word) {
+    value_t const* code = word->code;
+    value_t count = 0, size = 0, i, done = 0;
+    value_t* at;
+    uint16_t* toks;
+    if ((word->flags & F_PRIMITIVE_MSK) || (code[0] == (value_t)&Token_Enter_Word))
+        return 0;
+    /* Find the end of the instructions, skipping over the operands */
+    while (code[count])
+        count += onward_operand(code[count]) ? 2 : 1;
+    /* Find where each instruction starts in the token stream so the branch
+     * offsets can be translated */
+    at = (value_t*)malloc((size_t)(count + 1) * sizeof(value_t));
+    if (!at)
+        return 0;
+    for (i = 0; i < count; i++)
+        at[i] = -1;
+    for (i = 0; i < count; i += onward_operand(code[i]) ? 2 : 1) {
+        at[i] = size;
+        if (code[i] == W(lit))
+            size += token_small(code[i+1]) ? 1 : 1 + TOKEN_CELL_UNITS;
+        else
+            size += onward_operand(code[i]) ? 2 : 1;
+    }
+    at[count] = size++;
+    toks = (uint16_t*)malloc((size_t)size * sizeof(uint16_t));
+    done = (toks && token_emit(code, count, at, toks) && token_store(word, count, toks, size));
+    free(toks);
+    free(at);
+    return done;
+}
+
+uint16_t const* onward_token_code(word_t const* word) {
+    uint16_t const* toks = 0u;
+    if (!(word->flags & F_PRIMITIVE_MSK) && (word->code[0] == (value_t)&Token_Enter_Word))
+        toks = (uint16_t const*)(word->code + 1);
+    return toks;
+}
+
+word_t const* onward_token_word(value_t token) {
+    word_t const* word = 0u;
+    if ((token >= TOKEN_FIRST) && (token < __atomic_load_n(&Token_Count, __ATOMIC_ACQUIRE)))
+        word = Token_Words[token];
+    return word;
+}
+
+static word_t const* find_word(char const* name) {
+    word_t const* curr = (word_t const*)latest;
+    STAT_ADD(stat_finds, 1);
+    while(curr) {
+        STAT_ADD(stat_find_steps, 1);
+        if (0 == strcmp(curr->name,name))
+            break;
+        curr = curr->link;
+    }
+    return curr;
+}
+
+static value_t name_hash(char const* name) {
+    uint32_t hash = 2166136261u;
+    while (*name)
+        hash = (hash ^ (unsigned char)*name++) * 16777619u;
+    return (value_t)(hash % NAME_EPOCH_COUNT);
+}
+
+/* Input and Output Helpers
+ *****************************************************************************/
+/* Execute or compile the next word of input */
+static void interp_word(void) {
+    onward_scan_t scan;
+    /* Use the next word if it was scanned ahead, it is already parsed */
+    if (scan_word(&scan)) {
+        if (scan.number) {
+            onward_aspush(scan.value);
+        } else {
+            strcpy(Word_Name, scan.name);
+            onward_aspush((value_t)Word_Name);
+        }
+        onward_aspush(scan.number);
+    /* Otherwise grab the next word of input */
+    } else {
+        word_code();
+        /* Discard it if we did not actually get anything */
+        if (!strlen((char*)onward_aspeek(0))) {
+            (void)onward_aspop();
+            return;
+        }
+        /* Try to parse it as a number */
+        num_code();
+    }
+    /* If it's a number */
+    if (onward_aspop()) {
+        /* If we're compiling, then append the number to the word */
+        if (state == 1) {
+            onward_aspush((intptr_t)&lit);
+            comma_code();
+            comma_code();
+        }
+    /* otherwise, look it up */
+    } else {
+        char* name = (char*)onward_aspeek(0);
+        value_t index = (state == 1) ? local_find(name) : -1;
+        /* Locals of the word being compiled hide words with their name */
+        if (index >= 0) {
+            (void)onward_aspop();
+            onward_aspush(W(local_fetch));
+            comma_code();
+            onward_aspush(index);
+            comma_code();
+            return;
+        }
+        /* Lookup the word in the dictionary */
+        find_code();
+        /* If we found a definition execute it */
+        if (onward_aspeek(0)) {
+            /* If we are in immediate more or the word is immediate */
+            if((state == 0) || (((word_t*)onward_aspeek(0))->flags & F_IMMEDIATE))
+            {
+                exec_code();
+            }
+            /* Otherwise, compile it! */
+            else
+            {
+                comma_code();
+            }
+        /* Report an error */
+        } else {
+            (void)onward_aspop();
+            write_str("Unknown word: ");
+            write_str(name);
+            write_char('\n');
+            onward_throw(ERR_UNKNOWN_WORD);
+        }
+    }
+}
+
+/* Take the next word of the input from the words scanned ahead if it was
+ * scanned, leaving the input just as word would */
+static value_t scan_word(onward_scan_t* scan) {
+    if (!Scan_Next || !Input)
+        return 0;
+    while ((Input < Input_End) && char_oneof(*Input, " \t\r\n"))
+        Input++;
+    if ((Input >= Input_End) || !Scan_Next(Input, scan, Scan_Ctx) || (scan->end > Input_End))
+        return 0;
+    /* word also consumes the character that ends the word */
+    Input = scan->end + ((scan->end < Input_End) ? 1 : 0);
+    return 1;
+}
+
+static int read_char(void) {
+    int ch = EOF;
+    if (Input)
+        ch = (Input < Input_End) ? (int)(unsigned char)*Input++ : EOF;
+    else if (Fetch_Char)
+        ch = (int)Fetch_Char();
+    return ch;
+}
+
+static void write_char(value_t ch) {
+    if (Output) {
+        if (Output < Output_End)
+            *Output++ = (char)ch;
+    } else if (Emit_Char) {
+        Emit_Char(ch);
+    }
+}
+
+static void write_str(char const* str) {
+    while (*str)
+        write_char(*str++);
+}
+
 static value_t char_oneof(char ch, char* chs) {
     value_t ret = 0;
     while(*chs != '\0') {
@@ -583,3 +1833,409 @@ static value_t char_oneof(char ch, char* chs) {
     return ret;
 }
 
+
+/* Double-Cell Arithmetic Helpers
+ *****************************************************************************/
+static void umul_wide(uvalue_t lval, uvalue_t rval, uvalue_t* hi, uvalue_t* lo) {
+#ifndef NO_DVALUE
+    udvalue_t prod = (udvalue_t)lval * (udvalue_t)rval;
+    *lo = (uvalue_t)prod;
+    *hi = (uvalue_t)(prod >> CELL_BITS);
+#else
+    /* Schoolbook multiplication of the half-cell digits of each operand */
+    uvalue_t half = CELL_BITS / 2u;
+    uvalue_t mask = ((uvalue_t)1u << half) - 1u;
+    uvalue_t ll = (lval & mask) * (rval & mask);
+    uvalue_t lh = (lval & mask) * (rval >> half);
+    uvalue_t hl = (lval >> half) * (rval & mask);
+    uvalue_t hh = (lval >> half) * (rval >> half);
+    uvalue_t mid = (ll >> half) + (lh & mask) + (hl & mask);
+    *lo = (ll & mask) | (mid << half);
+    *hi = hh + (lh >> half) + (hl >> half) + (mid >> half);
+#endif
+}
+
+static void mul_wide(value_t lval, value_t rval, uvalue_t* hi, uvalue_t* lo) {
+#ifndef NO_DVALUE
+    udvalue_t prod = (udvalue_t)((dvalue_t)lval * (dvalue_t)rval);
+    *lo = (uvalue_t)prod;
+    *hi = (uvalue_t)(prod >> CELL_BITS);
+#else
+    /* Multiply the magnitudes and negate the product if the signs differ */
+    umul_wide((lval < 0) ? -(uvalue_t)lval : (uvalue_t)lval,
+              (rval < 0) ? -(uvalue_t)rval : (uvalue_t)rval, hi, lo);
+    if ((lval < 0) != (rval < 0)) {
+        *lo = ~*lo + 1u;
+        *hi = ~*hi + (0u == *lo);
+    }
+#endif
+}
+
+/* Divide a double-cell value by a cell. Returns zero without dividing if the
+ * divisor is zero or the quotient does not fit in a cell, which is the case
+ * whenever the high cell is not below the divisor. */
+static value_t udiv_wide(uvalue_t hi, uvalue_t lo, uvalue_t div, uvalue_t* quot, uvalue_t* rem) {
+    if (hi >= div)
+        return 0;
+#ifndef NO_DVALUE
+    udvalue_t num = ((udvalue_t)hi << CELL_BITS) | lo;
+    *rem  = (uvalue_t)(num % div);
+    *quot = (uvalue_t)(num / div);
+#else
+    /* Restoring division, shifting one bit of the dividend in at a time */
+    value_t i;
+    *quot = 0u;
+    for (i = 0; i < (value_t)CELL_BITS; i++) {
+        uvalue_t carry = hi >> (CELL_BITS - 1u);
+        hi    = (hi << 1u) | (lo >> (CELL_BITS - 1u));
+        lo    = lo << 1u;
+        *quot = *quot << 1u;
+        if (carry || (hi >= div)) {
+            hi    -= div;
+            *quot |= 1u;
+        }
+    }
+    *rem = hi;
+#endif
+    return 1;
+}
+
+/* Multiply two cells and divide the product by a third, truncating toward
+ * zero like the / word. Returns zero if the divisor is zero or the quotient
+ * does not fit in a cell. */
+static value_t muldiv_wide(value_t lval, value_t rval, value_t div, value_t* quot, value_t* rem) {
+#ifndef NO_DVALUE
+    dvalue_t prod = (dvalue_t)lval * (dvalue_t)rval;
+    dvalue_t dquot;
+    if (!div)
+        return 0;
+    dquot = prod / div;
+    if ((dvalue_t)(value_t)dquot != dquot)
+        return 0;
+    *rem  = (value_t)(prod % div);
+    *quot = (value_t)dquot;
+#else
+    /* Divide the magnitudes and give the quotient the sign of the result,
+     * which can hold one more negative value than positive */
+    uvalue_t hi, lo, urem, uquot;
+    value_t neg  = (lval < 0) != (rval < 0);
+    uvalue_t max = ((uvalue_t)1u << (CELL_BITS - 1u)) - (neg == (div < 0));
+    umul_wide((lval < 0) ? -(uvalue_t)lval : (uvalue_t)lval,
+              (rval < 0) ? -(uvalue_t)rval : (uvalue_t)rval, &hi, &lo);
+    if (!udiv_wide(hi, lo, (div < 0) ? -(uvalue_t)div : (uvalue_t)div, &uquot, &urem) || (uquot > max))
+        return 0;
+    *rem  = (value_t)(neg ? -urem : urem);
+    *quot = (value_t)((neg != (div < 0)) ? -uquot : uquot);
+#endif
+    return 1;
+}
+
+/* Error Handling Helpers
+ *****************************************************************************/
+/* Resume the loop with the given starting return stack if it owns the
+ * innermost catch frame, otherwise unwind it so its caller stops as well */
+static value_t throw_resume(value_t start) {
+    value_t resume = 0;
+    if (Throw_Code) {
+        if (handler && (((value_t*)handler)[-1] == Exec_Depth)) {
+            rsp     = handler;
+            handler = onward_rspop();
+            (void)onward_rspop();
+            asp     = onward_rspop();
+            pc      = onward_rspop();
+            onward_aspush(Throw_Code);
+            Throw_Code = 0;
+            resume     = 1;
+        } else if (Current_Task && (Current_Task != &Main_Task) && (Current_Task->depth == Exec_Depth)) {
+            /* The error unwound past the entry of a spawned task. The task is
+             * removed like stop does and the next task resumes on its own
+             * stacks, with the error left in errcode. */
+            task_remove();
+            Throw_Code = 0;
+            resume     = 1;
+        } else {
+            rsp = start;
+            pc  = 0;
+        }
+    }
+    return resume;
+}
+
+/* Remove the catch frame of a word that completed and push 0 */
+static void catch_exit_code(void) {
+    handler = onward_rspop();
+    (void)onward_rspop();
+    (void)onward_rspop();
+    pc = onward_rspop();
+    onward_aspush(0);
+}
+
+/* Token Threaded Code Helpers
+ *****************************************************************************/
+/* Check if a literal fits in the 15 bits of a literal token */
+static value_t token_small(value_t val) {
+    return ((val >= -0x4000) && (val < 0x4000));
+}
+
+/* Sign extend the value of a literal token */
+static value_t token_literal(uvalue_t tok) {
+    return (value_t)((int32_t)((tok & 0x7FFFu) ^ 0x4000u) - 0x4000);
+}
+
+/* Sign extend the 16-bit offset of a branch token */
+static value_t token_offset(uvalue_t off) {
+    return (value_t)((int32_t)((off & 0xFFFFu) ^ 0x8000u) - 0x8000);
+}
+
+/* Run the token stream of a word called from threaded code and return to the
+ * caller unless an error is unwinding */
+static void token_enter_code(void) {
+    value_t active = Inner_Active;
+    Inner_Active = 0;
+    token_run();
+    Inner_Active = active;
+    if (pc)
+        pc = onward_rspop();
+}
+
+/* Run tokens until the word that started the loop returns or an error clears
+ * pc. Token words are called within the loop, other words are run by a nested
+ * interpreter loop. */
+static void token_run(void) {
+    value_t start = rsp;
+    onward_frame_t frame;
+    Exec_Depth++;
+    Token_Depth++;
+    /* A thrown error clears pc and jumps back here, stopping the loop */
+    onward_frame_push(&frame);
+    (void)setjmp(frame.jump);
+    while (pc) {
+        uint16_t const* ip = (uint16_t const*)pc;
+        uvalue_t tok = *ip++;
+        pc = (value_t)ip;
+        STAT_ADD(stat_dispatches, 1);
+        /* Record the instruction in the trace buffer if tracing is enabled */
+        if (trbuf) {
+            trace_t* entry = ((trace_t*)trbuf) + (trpos++ & (trsz - 1));
+            entry->pc   = pc - sizeof(uint16_t);
+            entry->word = (tok & TOKEN_LITERAL) ? &lit : Token_Words[tok];
+            entry->tos  = (asp > asb) ? *((value_t*)asp) : 0;
+        }
+        if (tok & TOKEN_LITERAL) {
+            onward_aspush(token_literal(tok));
+        } else if (tok >= TOKEN_FIRST) {
+            word_t const* word = Token_Words[tok];
+            if (word->flags & F_PRIMITIVE_MSK) {
+                STAT_ADD(stat_prim_calls, 1);
+                ((primitive_t)word->code)();
+            } else if (word->code[0] == (value_t)&Token_Enter_Word) {
+                /* pc is set first so an overflow of the return stack clears it */
+                value_t ret = pc;
+                if (LIMIT_EXCEEDED())
+                    continue;
+                STAT_ADD(stat_colon_calls, 1);
+                pc = (value_t)(word->code + 1);
+                onward_rspush(ret);
+            } else {
+                onward_exec(word);
+            }
+        } else if (tok == TOKEN_EXIT) {
+            if (rsp == start)
+                break;
+            pc = onward_rspop();
+        } else if (tok == TOKEN_LIT) {
+            value_t val;
+            memcpy(&val, ip, sizeof(value_t));
+            pc += sizeof(value_t);
+            onward_aspush(val);
+        } else if (tok == TOKEN_TICK) {
+            pc += sizeof(uint16_t);
+            onward_aspush((value_t)Token_Words[*ip]);
+        } else if ((tok == TOKEN_BR) || !onward_aspop()) {
+            value_t offset = token_offset(*ip);
+            if ((offset > 0) || !LIMIT_EXCEEDED())
+                pc += offset * (value_t)sizeof(uint16_t);
+        } else {
+            pc += sizeof(uint16_t);
+        }
+    }
+    onward_frame_pop(&frame);
+    Token_Depth--;
+    Exec_Depth--;
+}
+
+/* Find the token of a word, assigning the next free token if it has none.
+ * Returns 0 if every token is in use. */
+static uint16_t token_lookup(word_t const* word) {
+    uvalue_t i = (((uvalue_t)word >> 3u) * (uvalue_t)UINT64_C(0x9E3779B97F4A7C15)) >> (CELL_BITS - TOKEN_INDEX_BITS);
+    uint16_t tok = 0;
+    pthread_mutex_lock(&Token_Lock);
+    for (; Token_Index[i] && !tok; i = (i + 1u) & (TOKEN_INDEX_SIZE - 1u)) {
+        if (Token_Words[Token_Index[i]] == word)
+            tok = Token_Index[i];
+    }
+    if (!tok && (Token_Count < (value_t)TOKEN_COUNT)) {
+        tok = (uint16_t)Token_Count;
+        Token_Words[tok] = word;
+        Token_Index[i]   = tok;
+        __atomic_store_n(&Token_Count, Token_Count + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&Token_Lock);
+    return tok;
+}
+
+/* Translate the instructions of a word to tokens at the positions given for
+ * each instruction. Returns 0 if a word has no token or a branch cannot be
+ * encoded. */
+static value_t token_emit(value_t const* code, value_t count, value_t const* at, uint16_t* toks) {
+    value_t i;
+    for (i = 0; i < count; i += onward_operand(code[i]) ? 2 : 1) {
+        uint16_t* out = toks + at[i];
+        if (code[i] == W(lit)) {
+            value_t val = code[i+1];
+            if (token_small(val)) {
+                out[0] = (uint16_t)(TOKEN_LITERAL | ((uvalue_t)val & 0x7FFFu));
+            } else {
+                out[0] = TOKEN_LIT;
+                memcpy(&out[1], &val, sizeof(value_t));
+            }
+        } else if ((code[i] == W(br)) || (code[i] == W(zbr))) {
+            /* Offsets are relative to the operand in both encodings */
+            value_t target = i + 1 + (code[i+1] / (value_t)sizeof(value_t));
+            value_t offset;
+            if ((code[i+1] % (value_t)sizeof(value_t)) || (target < 0) || (target > count) || (at[target] < 0))
+                return 0;
+            offset = at[target] - (at[i] + 1);
+            if ((offset < INT16_MIN) || (offset > INT16_MAX))
+                return 0;
+            out[0] = (code[i] == W(br)) ? TOKEN_BR : TOKEN_ZBR;
+            out[1] = (uint16_t)((uvalue_t)offset & 0xFFFFu);
+        } else if (code[i] == W(tick)) {
+            out[0] = TOKEN_TICK;
+            if (!(out[1] = token_lookup((word_t const*)code[i+1])))
+                return 0;
+        } else if (onward_operand(code[i])) {
+            /* Other operands are small counts held in the token that follows */
+            if ((code[i+1] < 0) || (code[i+1] > (value_t)UINT16_MAX) ||
+                !(out[0] = token_lookup((word_t const*)code[i])))
+                return 0;
+            out[1] = (uint16_t)code[i+1];
+        } else if (!(out[0] = token_lookup((word_t const*)code[i]))) {
+            return 0;
+        }
+    }
+    toks[at[count]] = TOKEN_EXIT;
+    return 1;
+}
+
+/* Replace the code of a word with the token stream. The latest definition is
+ * rewritten in place so the space it saves is given back to the dictionary,
+ * other words get a new copy at here. */
+static value_t token_store(word_t* word, value_t count, uint16_t const* toks, value_t size) {
+    value_t bytes = sizeof(value_t) + (size * (value_t)sizeof(uint16_t));
+    value_t* dest = word->code;
+    bytes = (bytes + sizeof(value_t) - 1) & ~(value_t)(sizeof(value_t) - 1);
+    if ((value_t)(word->code + count + 1) != here) {
+        here = (here + sizeof(value_t) - 1) & ~(value_t)(sizeof(value_t) - 1);
+        dest = (value_t*)here;
+    }
+    /* Rewriting the latest definition in place only gives space back */
+    if ((((value_t)dest + bytes) > here) && !dict_fits(((value_t)dest + bytes) - here))
+        return 0;
+    dest[0] = (value_t)&Token_Enter_Word;
+    memcpy(dest + 1, toks, (size_t)size * sizeof(uint16_t));
+    word->code = dest;
+    here = (value_t)dest + bytes;
+    STAT_MAX(stat_dict_max, here - hbase);
+    return 1;
+}
+
+/* Stack and Local Variable Helpers
+ *****************************************************************************/
+/* Get the top item of the argument stack, throwing an error if there are fewer
+ * than the given number of items so the items below it can be accessed too */
+static value_t* as_cells(value_t count) {
+    if ((asp - (count * (value_t)sizeof(value_t))) < asb) {
+        onward_throw(ERR_ARG_STACK_UNDRFLW);
+        return NULL;
+    }
+    return (value_t*)asp;
+}
+
+/* Fetch the operand of the running instruction. Token threaded code stores it
+ * in the token that follows. */
+static value_t operand_fetch(void) {
+    value_t val;
+    if (Inner_Active) {
+        val = onward_pcfetch();
+    } else {
+        val = *((uint16_t const*)pc);
+        pc += sizeof(uint16_t);
+    }
+    return val;
+}
+
+/* Find the index of a local of the word being compiled counting down from the
+ * top of its frame, or -1 if there is none with the name */
+static value_t local_find(char const* name) {
+    value_t i;
+    for (i = 0; i < Local_Count; i++) {
+        if (!strcmp(Local_Names[i], name))
+            return Local_Count - 1 - i;
+    }
+    return -1;
+}
+
+/* Execution Limit Helpers
+ *****************************************************************************/
+/* Charge a backward branch or call against the fuel and compare the clock to
+ * the deadline every LIMIT_CLOCK_CHECKS charges. Throws and returns non-zero
+ * if either is exhausted. They stay exhausted so a catch cannot keep going. */
+static value_t limit_exceeded(void) {
+    value_t code = ERR_NONE;
+    if (Limit_Fuel == 0)
+        code = ERR_OUT_OF_FUEL;
+    else if (Limit_Fuel > 0)
+        Limit_Fuel--;
+    if (!code && Limit_Deadline && (--Clock_Checks <= 0)) {
+        if (limit_clock() >= Limit_Deadline)
+            code = ERR_DEADLINE;
+        else
+            Clock_Checks = LIMIT_CLOCK_CHECKS;
+    }
+    onward_throw(code);
+    return (code != ERR_NONE);
+}
+
+/* Read the monotonic clock in nanoseconds */
+static int64_t limit_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000000) + (int64_t)ts.tv_nsec;
+}
+
+/* Check that moving here forward by the given number of bytes keeps it within
+ * the word buffer and the quota of the evaluation. A dictionary placed outside
+ * the word buffer is only held to the quota. Space is only given back by
+ * rollback so a negative size never fits. */
+static value_t dict_fits(value_t size) {
+    value_t end = hbase + hsize;
+    value_t fits = (size >= 0);
+    if ((here >= hbase) && (here <= end))
+        fits = (fits && (size <= (end - here)));
+    if (Limit_End) {
+        fits = (fits && (here >= Limit_Base) && (here <= Limit_End) &&
+                (size <= (Limit_End - here)));
+    }
+    return fits;
+}
+
+/* Check that the given number of bytes can be compiled at here, throwing if
+ * they cannot */
+static value_t dict_room(value_t size) {
+    if (!dict_fits(size)) {
+        onward_throw(ERR_DICT_FULL);
+        return 0;
+    }
+    return 1;
+}
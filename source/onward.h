@@ -6,17 +6,46 @@
 #define ONWARD_H
 
 #include <stdint.h>
+#include <setjmp.h>
 
 #if defined(BITS_16)
     typedef int16_t value_t;
+    typedef uint16_t uvalue_t;
+    typedef int32_t dvalue_t;
+    typedef uint32_t udvalue_t;
 #elif defined(BITS_32)
     typedef int32_t value_t;
+    typedef uint32_t uvalue_t;
+    typedef int64_t dvalue_t;
+    typedef uint64_t udvalue_t;
 #elif defined(BITS_64)
     typedef int64_t value_t;
+    typedef uint64_t uvalue_t;
+    #define DVALUE_FROM_INT128
 #else
     typedef intptr_t value_t;
+    typedef uintptr_t uvalue_t;
+    #if (INTPTR_MAX == INT32_MAX)
+        typedef int64_t dvalue_t;
+        typedef uint64_t udvalue_t;
+    #else
+        #define DVALUE_FROM_INT128
+    #endif
 #endif
 
+/* Double-cell values use the compiler's 128-bit integers when the cell is 64
+ * bits wide. Without them the double-cell words fall back to portable code. */
+#if defined(DVALUE_FROM_INT128) && defined(__SIZEOF_INT128__)
+    __extension__ typedef __int128 dvalue_t;
+    __extension__ typedef unsigned __int128 udvalue_t;
+#elif defined(DVALUE_FROM_INT128)
+    #define NO_DVALUE
+#endif
+#undef DVALUE_FROM_INT128
+
+/** The number of bits in a cell */
+#define CELL_BITS (sizeof(value_t) * 8u)
+
 /** This structure represents a word definition */
 typedef struct word_t {
     /** Pointer to the next most recently defined word in the dictionary. */
@@ -33,6 +62,16 @@ typedef struct word_t {
 /** Type definition for the C function associated with primitive words */
 typedef void (*primitive_t)(void);
 
+/** An entry in the instruction trace ring buffer */
+typedef struct {
+    /** Address of the instruction that was dispatched */
+    value_t pc;
+    /** The word that was dispatched or 0u (NULL) for a return */
+    word_t const* word;
+    /** The value on top of the argument stack when the word was dispatched */
+    value_t tos;
+} trace_t;
+
 typedef struct {
     value_t* arg_stack;
     value_t  arg_stack_sz;
@@ -41,11 +80,128 @@ typedef struct {
     value_t* word_buf;
     value_t  word_buf_sz;
     word_t*  latest;
+    /** Function used to read a character when no input buffer is active. May
+     * be 0u (NULL) in which case the input is always at end of file. */
+    value_t (*fetch_char)(void);
+    /** Function used to write a character when no output buffer is active. May
+     * be 0u (NULL) in which case the output is discarded. */
+    void (*emit_char)(value_t);
 } onward_init_t;
 
-#define deccode(c_name)       \
-    void c_name##_code(void); \
-    const word_t c_name
+/** A reference to a word by name that caches the result of the lookup. The
+ * cached word is discarded when a word with a similar name is created or the
+ * handle is resolved in a dictionary that does not extend the one it was
+ * resolved in. */
+typedef struct {
+    /** Pointer to the null terminated name of the referenced word */
+    char const* name;
+    /** The word the name resolved to or 0u (NULL) if it was not found */
+    word_t const* word;
+    /** The latest word of the dictionary the name was resolved in */
+    word_t const* latest;
+    /** Index of the name bucket whose generation is tracked */
+    value_t bucket;
+    /** Generation of the name bucket when the word was resolved */
+    value_t epoch;
+} onward_xt_t;
+
+/** The size of the buffer word reads into, longer words are truncated */
+#define WORD_NAME_SZ (32u)
+
+/** A word of input scanned ahead of the interpreter */
+typedef struct {
+    /** Address of the first character of the word */
+    char const* start;
+    /** Address of the character after the word */
+    char const* end;
+    /** Non-zero if the word is a number literal */
+    value_t number;
+    /** The value of the number literal */
+    value_t value;
+    /** The word as it would be read by word */
+    char name[WORD_NAME_SZ];
+} onward_scan_t;
+
+/** Function that fetches the scanned word starting at the given address. It
+ * returns 0 if none of the words scanned ahead start there, discarding those
+ * that start before it. */
+typedef value_t (*onward_scan_fn_t)(char const* start, onward_scan_t* scan, void* ctx);
+
+/** A cooperatively scheduled task. The registers hold the state of the task
+ * while it is not running. */
+typedef struct task_t {
+    /** The next task in the round-robin schedule */
+    struct task_t* next;
+    value_t pc;
+    value_t asb;
+    value_t assz;
+    value_t asp;
+    value_t rsb;
+    value_t rssz;
+    value_t rsp;
+    value_t handler;
+    /** The interpreter loop depth the task was last resumed in */
+    value_t depth;
+    /** Instructions that execute the word of the task and then stop it. If
+     * stop cannot switch away, the task returns past the bottom of its return
+     * stack, which throws, rather than running on. */
+    value_t code[3];
+} task_t;
+
+/** A point on the C stack that a thrown error unwinds to. The interpreter
+ * loops and evaluations each push one so a primitive never runs on after a
+ * throw. C code that has to clean up after a throw pushes its own and calls
+ * setjmp() on the jump buffer, which returns non-zero when an error arrives. */
+typedef struct onward_frame_t {
+    /** The frame that was innermost before this one was pushed */
+    struct onward_frame_t* prev;
+    /** The error code thrown to the frame or 0 if none was */
+    volatile value_t code;
+    jmp_buf jump;
+} onward_frame_t;
+
+/** This structure holds the state of an interpreter instance while it is not
+ * the active instance */
+typedef struct {
+    value_t pc;
+    value_t asb;
+    value_t assz;
+    value_t asp;
+    value_t rsb;
+    value_t rssz;
+    value_t rsp;
+    value_t hbase;
+    value_t here;
+    value_t hsize;
+    value_t errcode;
+    value_t latest;
+    value_t state;
+    value_t handler;
+    /** The remaining input being interpreted or 0u (NULL) to use fetch_char */
+    char const* input;
+    char const* input_end;
+    /** Buffer that receives the output of emit or 0u (NULL) to use emit_char,
+     * set with onward_vm_output(). The pointer is advanced as characters are
+     * written and output past output_end is discarded. */
+    char* output;
+    char* output_end;
+    value_t (*fetch_char)(void);
+    void (*emit_char)(value_t);
+    /** The limits left to the evaluation in progress. See onward_limit(). */
+    value_t fuel;
+    int64_t deadline;
+    value_t hlimit_base;
+    value_t hlimit;
+    /** The limits applied at the start of each evaluation, 0 if unlimited. See
+     * onward_vm_limit(). */
+    value_t limit_fuel;
+    value_t limit_ns;
+    value_t limit_bytes;
+} onward_vm_t;
+
+#define deccode(c_name)              \
+    extern void c_name##_code(void); \
+    extern const word_t c_name
 
 /** Define a built-in word that executes native code */
 #define defcode(name_str, c_name, prev, flags) \
@@ -61,7 +217,7 @@ typedef struct {
     void c_name##_code(void)
 
 #define decword(c_name) \
-    const word_t c_name
+    extern const word_t c_name
 
 /** Define a built-in word that is defined by references to other words. */
 #define defword(name_str, c_name, prev, flags) \
@@ -76,9 +232,26 @@ typedef struct {
     const char c_name##_str[] = name_str;      \
     const value_t c_name##_code[] =
 
+/** Storage class of the interpreter registers. Every thread that runs the
+ * interpreter has its own set of registers. */
+#ifndef ONWARD_TLS
+#define ONWARD_TLS __thread
+#endif
+
+#define decreg(c_name)                \
+    extern ONWARD_TLS value_t c_name; \
+    extern const word_t c_name##_word
+
+/** Define a built-in word representing an interpreter register */
+#define defreg(name_str, c_name, initial, prev)  \
+    extern ONWARD_TLS value_t c_name;            \
+    defcode(name_str, c_name##_word, prev, 0u) { \
+        onward_aspush((value_t)&c_name); }       \
+    ONWARD_TLS value_t c_name = initial
+
 #define decvar(c_name)         \
-    value_t c_name;            \
-    const word_t c_name##_word
+    extern value_t c_name;     \
+    extern const word_t c_name##_word
 
 /** Define a built-in word representing a variable with the provided value */
 #define defvar(name_str, c_name, initial, prev)  \
@@ -87,9 +260,9 @@ typedef struct {
         onward_aspush((value_t)&c_name); }       \
     value_t c_name = initial
 
-#define decconst(c_name)       \
-    const value_t c_name;      \
-    const word_t c_name##_word
+#define decconst(c_name)        \
+    extern const value_t c_name; \
+    extern const word_t c_name##_word
 
 /** Define a built-in word representing a constant with the provided value */
 #define defconst(name_str, c_name, value, prev)  \
@@ -104,6 +277,13 @@ typedef struct {
 #define ERR_ARG_STACK_UNDRFLW (0x03)
 #define ERR_RET_STACK_OVRFLW  (0x04)
 #define ERR_RET_STACK_UNDRFLW (0x05)
+#define ERR_FILE_NOT_FOUND    (0x06)
+#define ERR_TABLE_FULL        (0x07)
+#define ERR_OUT_OF_FUEL       (0x08)
+#define ERR_DEADLINE          (0x09)
+#define ERR_DICT_FULL         (0x0A)
+#define ERR_BAD_SIZE          (0x0B)
+#define ERR_BAD_DIVIDE        (0x0C)
 
 /** The number of bits that make up a stack cell */
 #define SYS_BITCOUNT ((value_t)(sizeof(value_t) * 8u))
@@ -117,18 +297,77 @@ typedef struct {
 /** Bit mask to retrieve the "immediate" flag */
 #define F_IMMEDIATE_MSK ((value_t)((value_t)1u << (SYS_BITCOUNT-3u)))
 
+/** Token threaded code is a stream of 16-bit tokens. A token with the top bit
+ * set pushes the sign extended value of its other 15 bits, otherwise it is
+ * either one of the reserved tokens below or indexes the token table. */
+#define TOKEN_LITERAL (0x8000u)
+
+/** Return from the word */
+#define TOKEN_EXIT (0u)
+
+/** Push the full cell stored in the tokens that follow */
+#define TOKEN_LIT (1u)
+
+/** Branch by the signed number of tokens that follows, relative to it */
+#define TOKEN_BR (2u)
+
+/** Branch like TOKEN_BR if the top item on the stack is 0 */
+#define TOKEN_ZBR (3u)
+
+/** Push the word with the token that follows */
+#define TOKEN_TICK (4u)
+
+/** The first token assigned to a word */
+#define TOKEN_FIRST (5u)
+
+/** The number of tokens that can be assigned to words plus the reserved ones */
+#define TOKEN_COUNT (0x8000u)
+
+/** The number of tokens holding a full cell literal */
+#define TOKEN_CELL_UNITS ((value_t)(sizeof(value_t) / sizeof(uint16_t)))
+
 /** Macro to get use the word pointer in a defined word */
 #define W(name) ((value_t)&name)
 
 /** Macro that expands to the address of the latest built-in word */
-#define LATEST_BUILTIN (&bnot)
+#define LATEST_BUILTIN (&chan_recv_slice)
 
 value_t onward_pcfetch(void);
+value_t onward_operand(value_t instr);
+value_t onward_number(char const* str, value_t len, value_t* val);
 void onward_aspush(value_t val);
 value_t onward_aspeek(value_t val);
 value_t onward_aspop(void);
 void onward_rspush(value_t val);
 value_t onward_rspop(void);
+void onward_throw(value_t code);
+void onward_frame_push(onward_frame_t* frame);
+void onward_frame_pop(onward_frame_t* frame);
+void onward_init(onward_init_t const* init);
+value_t onward_eval(char const* source, value_t length);
+char const* onward_eval_scanned(char const* source, value_t length, onward_scan_fn_t next, void* ctx);
+char const* onward_scan(char const* source, char const* end, onward_scan_t* scan);
+void onward_exec(word_t const* word);
+void onward_limit(value_t count, value_t timeout_ns, value_t bytes);
+value_t onward_limited(void);
+value_t onward_allot(value_t size);
+void onward_vm_init(onward_vm_t* vm, onward_init_t const* init);
+value_t onward_vm_eval(onward_vm_t* vm, char const* source, value_t length);
+value_t onward_vm_call(onward_vm_t* vm, word_t const* word);
+void onward_vm_limit(onward_vm_t* vm, value_t count, value_t timeout_ns, value_t bytes);
+void onward_vm_output(onward_vm_t* vm, char* buf, value_t size);
+word_t const* onward_vm_find(onward_vm_t* vm, char const* name);
+void onward_vm_push(onward_vm_t* vm, value_t val);
+value_t onward_vm_pop(onward_vm_t* vm);
+value_t onward_vm_depth(onward_vm_t* vm);
+word_t const* onward_vm_resolve(onward_vm_t* vm, onward_xt_t* xt);
+void onward_xt_init(onward_xt_t* xt, char const* name);
+word_t const* onward_xt_resolve(onward_xt_t* xt);
+void onward_trace_init(trace_t* buf, value_t count);
+trace_t const* onward_trace_entry(value_t age);
+value_t onward_tokenize(word_t* word);
+uint16_t const* onward_token_code(word_t const* word);
+word_t const* onward_token_word(value_t token);
 
 decconst(VERSION);
 decconst(CELLSZ);
@@ -136,15 +375,33 @@ decconst(BITCOUNT);
 decconst(F_PRIMITIVE);
 decconst(F_HIDDEN);
 decconst(F_IMMEDIATE);
-decvar(pc);
-decvar(asb);
-decvar(asp);
-decvar(rsb);
-decvar(rsp);
-decvar(errcode);
-decvar(latest);
-decvar(state);
-decvar(here);
+decreg(pc);
+decreg(asb);
+decreg(assz);
+decreg(asp);
+decreg(rsb);
+decreg(rssz);
+decreg(rsp);
+decreg(hbase);
+decreg(errcode);
+decreg(latest);
+decreg(state);
+decreg(here);
+decreg(hsize);
+decreg(trbuf);
+decreg(trsz);
+decreg(trpos);
+decreg(handler);
+decreg(tokens);
+decreg(stat_dispatches);
+decreg(stat_prim_calls);
+decreg(stat_colon_calls);
+decreg(stat_finds);
+decreg(stat_find_steps);
+decreg(stat_compiled);
+decreg(stat_as_max);
+decreg(stat_rs_max);
+decreg(stat_dict_max);
 deccode(key);
 deccode(emit);
 deccode(word);
@@ -153,8 +410,12 @@ deccode(num);
 deccode(lit);
 deccode(find);
 deccode(exec);
+deccode(handle);
+deccode(hfind);
+deccode(hexec);
 deccode(create);
 deccode(comma);
+deccode(allot);
 deccode(lbrack);
 deccode(rbrack);
 decword(colon);
@@ -163,6 +424,19 @@ deccode(tick);
 deccode(br);
 deccode(zbr);
 deccode(interp);
+deccode(evaluate);
+deccode(_catch);
+deccode(_throw);
+deccode(rollback);
+deccode(marker);
+deccode(forget);
+deccode(tokenize);
+deccode(locals);
+deccode(local_fetch);
+deccode(local_store);
+deccode(unlocals);
+deccode(lbrace);
+deccode(to);
 deccode(fetch);
 deccode(store);
 deccode(add_store);
@@ -177,6 +451,11 @@ deccode(dup_if);
 deccode(over);
 deccode(rot);
 deccode(nrot);
+deccode(pick);
+deccode(roll);
+deccode(two_dup);
+deccode(two_swap);
+deccode(two_drop);
 deccode(add);
 deccode(sub);
 deccode(mul);
@@ -192,5 +471,61 @@ deccode(band);
 deccode(bor);
 deccode(bxor);
 deccode(bnot);
+deccode(umul);
+deccode(mmul);
+deccode(umdivmod);
+deccode(muldivmod);
+deccode(muldiv);
+deccode(spawn);
+deccode(_pause);
+deccode(stop);
+deccode(tasks);
+deccode(stats);
+deccode(par_threads);
+deccode(par_map);
+deccode(par_reduce);
+deccode(table_bytes);
+deccode(table_init);
+deccode(table);
+deccode(strtable);
+deccode(table_store);
+deccode(table_fetch);
+deccode(table_delete);
+deccode(table_count);
+deccode(table_each);
+deccode(sort);
+deccode(radix_sort);
+deccode(slice);
+deccode(slash_string);
+deccode(dash_trailing);
+deccode(split);
+deccode(search);
+deccode(compare);
+deccode(snum);
+deccode(slice_type);
+decconst(MO_RELAXED);
+decconst(MO_ACQUIRE);
+decconst(MO_RELEASE);
+decconst(MO_ACQ_REL);
+decconst(MO_SEQ_CST);
+deccode(afetch);
+deccode(astore);
+deccode(afetch_add);
+deccode(acas);
+deccode(afence);
+deccode(chan_bytes);
+deccode(chan_init);
+deccode(chan);
+deccode(mpmc_chan);
+deccode(chan_send);
+deccode(chan_recv);
+deccode(chan_try_send);
+deccode(chan_try_recv);
+deccode(chan_send_n);
+deccode(chan_recv_n);
+deccode(chan_try_send_n);
+deccode(chan_try_recv_n);
+deccode(chan_send_slice);
+deccode(chan_recv_slice);
 
 #endif /* ONWARD_H */
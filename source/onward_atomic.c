@@ -0,0 +1,132 @@
+#include "onward.h"
+
+static value_t atomic_load_order(value_t* addr, value_t order);
+static void atomic_store_order(value_t* addr, value_t val, value_t order);
+static value_t atomic_add_order(value_t* addr, value_t val, value_t order);
+static value_t atomic_cas_order(value_t* addr, value_t expected, value_t val, value_t order);
+static void atomic_fence_order(value_t order);
+
+/** Memory order that only makes the access itself atomic */
+defconst("relaxed", MO_RELAXED, __ATOMIC_RELAXED, &slice_type);
+
+/** Memory order that keeps later accesses after the access */
+defconst("acquire", MO_ACQUIRE, __ATOMIC_ACQUIRE, &MO_RELAXED_word);
+
+/** Memory order that keeps earlier accesses before the access */
+defconst("release", MO_RELEASE, __ATOMIC_RELEASE, &MO_ACQUIRE_word);
+
+/** Memory order that combines acquire and release */
+defconst("acq-rel", MO_ACQ_REL, __ATOMIC_ACQ_REL, &MO_RELEASE_word);
+
+/** Memory order that also places the access in a single total order */
+defconst("seq-cst", MO_SEQ_CST, __ATOMIC_SEQ_CST, &MO_ACQ_REL_word);
+
+/** Atomically fetch the cell at a cell-aligned address with the given memory
+ * order */
+defcode("atomic@", afetch, &MO_SEQ_CST_word, 0u) {
+    value_t order = onward_aspop();
+    value_t* addr = (value_t*)onward_aspop();
+    onward_aspush(atomic_load_order(addr, order));
+}
+
+/** Atomically store a value in the cell at a cell-aligned address with the
+ * given memory order */
+defcode("atomic!", astore, &afetch, 0u) {
+    value_t order = onward_aspop();
+    value_t val   = onward_aspop();
+    value_t* addr = (value_t*)onward_aspop();
+    atomic_store_order(addr, val, order);
+}
+
+/** Atomically add a value to the cell at a cell-aligned address with the given
+ * memory order, pushing the value it held before */
+defcode("atomic-add", afetch_add, &astore, 0u) {
+    value_t order = onward_aspop();
+    value_t val   = onward_aspop();
+    value_t* addr = (value_t*)onward_aspop();
+    onward_aspush(atomic_add_order(addr, val, order));
+}
+
+/** Atomically replace the cell at a cell-aligned address with a new value if
+ * it holds the expected value, pushing the value it held before. The swap
+ * succeeded if that is the expected value. */
+defcode("atomic-cas", acas, &afetch_add, 0u) {
+    value_t order    = onward_aspop();
+    value_t val      = onward_aspop();
+    value_t expected = onward_aspop();
+    value_t* addr    = (value_t*)onward_aspop();
+    onward_aspush(atomic_cas_order(addr, expected, val, order));
+}
+
+/** Order the memory accesses before and after it with the given memory order */
+defcode("fence", afence, &acas, 0u) {
+    atomic_fence_order(onward_aspop());
+}
+
+/* Helper C Functions
+ *****************************************************************************/
+/* The builtins need a constant memory order to use it, so each order is
+ * dispatched to its own call. Orders that are not valid for the operation are
+ * strengthened to the nearest one that is. */
+static value_t atomic_load_order(value_t* addr, value_t order) {
+    switch (order) {
+        case __ATOMIC_RELAXED: return __atomic_load_n(addr, __ATOMIC_RELAXED);
+        case __ATOMIC_CONSUME:
+        case __ATOMIC_ACQUIRE: return __atomic_load_n(addr, __ATOMIC_ACQUIRE);
+        default:               return __atomic_load_n(addr, __ATOMIC_SEQ_CST);
+    }
+}
+
+static void atomic_store_order(value_t* addr, value_t val, value_t order) {
+    switch (order) {
+        case __ATOMIC_RELAXED: __atomic_store_n(addr, val, __ATOMIC_RELAXED); break;
+        case __ATOMIC_RELEASE: __atomic_store_n(addr, val, __ATOMIC_RELEASE); break;
+        default:               __atomic_store_n(addr, val, __ATOMIC_SEQ_CST); break;
+    }
+}
+
+static value_t atomic_add_order(value_t* addr, value_t val, value_t order) {
+    switch (order) {
+        case __ATOMIC_RELAXED: return __atomic_fetch_add(addr, val, __ATOMIC_RELAXED);
+        case __ATOMIC_CONSUME:
+        case __ATOMIC_ACQUIRE: return __atomic_fetch_add(addr, val, __ATOMIC_ACQUIRE);
+        case __ATOMIC_RELEASE: return __atomic_fetch_add(addr, val, __ATOMIC_RELEASE);
+        case __ATOMIC_ACQ_REL: return __atomic_fetch_add(addr, val, __ATOMIC_ACQ_REL);
+        default:               return __atomic_fetch_add(addr, val, __ATOMIC_SEQ_CST);
+    }
+}
+
+/* A failed swap is only a load, so it uses the order without its release */
+static value_t atomic_cas_order(value_t* addr, value_t expected, value_t val, value_t order) {
+    switch (order) {
+        case __ATOMIC_RELAXED:
+            (void)__atomic_compare_exchange_n(addr, &expected, val, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+            break;
+        case __ATOMIC_CONSUME:
+        case __ATOMIC_ACQUIRE:
+            (void)__atomic_compare_exchange_n(addr, &expected, val, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE);
+            break;
+        case __ATOMIC_RELEASE:
+            (void)__atomic_compare_exchange_n(addr, &expected, val, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+            break;
+        case __ATOMIC_ACQ_REL:
+            (void)__atomic_compare_exchange_n(addr, &expected, val, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+            break;
+        default:
+            (void)__atomic_compare_exchange_n(addr, &expected, val, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+            break;
+    }
+    /* The expected value is replaced by the current one if the swap failed */
+    return expected;
+}
+
+static void atomic_fence_order(value_t order) {
+    switch (order) {
+        case __ATOMIC_RELAXED: break;
+        case __ATOMIC_CONSUME:
+        case __ATOMIC_ACQUIRE: __atomic_thread_fence(__ATOMIC_ACQUIRE); break;
+        case __ATOMIC_RELEASE: __atomic_thread_fence(__ATOMIC_RELEASE); break;
+        case __ATOMIC_ACQ_REL: __atomic_thread_fence(__ATOMIC_ACQ_REL); break;
+        default:               __atomic_thread_fence(__ATOMIC_SEQ_CST); break;
+    }
+}
@@ -0,0 +1,332 @@
+#include "onward.h"
+#include <sched.h>
+
+/* The number of bytes that separate the positions updated by each side so the
+ * sender and receiver do not write to the same cache line */
+#define CHAN_LINE 64
+
+/* The most slots a channel may have so that its size in bytes fits in a cell */
+#define CHAN_MAX_SLOTS (((uvalue_t)1u << (CELL_BITS - 2u)) / sizeof(chan_slot_t))
+
+typedef struct {
+    /* For a channel of many threads, the position the slot can next be written
+     * at, or that plus one once it holds a cell to be read at that position */
+    uvalue_t seq;
+    value_t val;
+} chan_slot_t;
+
+typedef struct {
+    /* The number of slots minus one, the number of slots is a power of 2 */
+    uvalue_t mask;
+    /* Whether any number of threads may send and receive, otherwise only one
+     * thread may send and one thread may receive */
+    value_t multi;
+    char pad0[CHAN_LINE];
+    /* The position of the next cell sent. A single sender also keeps the last
+     * position of the receiver it saw so it rarely has to read it. */
+    uvalue_t tail;
+    uvalue_t head_seen;
+    char pad1[CHAN_LINE];
+    /* The position of the next cell received and the last position of the
+     * sender seen by a single receiver */
+    uvalue_t head;
+    uvalue_t tail_seen;
+    char pad2[CHAN_LINE];
+    chan_slot_t slots[];
+} chan_t;
+
+static uvalue_t chan_capacity(value_t limit);
+static chan_t* chan_setup(void* addr, uvalue_t capacity, value_t multi);
+static value_t chan_put(chan_t* chan, value_t const* cells, value_t count, value_t all);
+static value_t chan_get(chan_t* chan, value_t* cells, value_t count, value_t all);
+static void chan_put_all(chan_t* chan, value_t const* cells, value_t count, value_t whole);
+static void chan_get_all(chan_t* chan, value_t* cells, value_t count, value_t whole);
+
+/** Push the number of bytes needed by a channel holding the given number of
+ * cells */
+defcode("chan-bytes", chan_bytes, &afence, 0u) {
+    uvalue_t capacity = chan_capacity(onward_aspop());
+    if (capacity)
+        onward_aspush(sizeof(chan_t) + (capacity * sizeof(chan_slot_t)));
+}
+
+/** Initialize a channel at the given address holding at least the given
+ * number of cells. Any number of threads may use it if the top item is
+ * non-zero, otherwise only one sender and one receiver. */
+defcode("chan-init", chan_init, &chan_bytes, 0u) {
+    value_t multi     = onward_aspop();
+    uvalue_t capacity = chan_capacity(onward_aspop());
+    void* addr        = (void*)onward_aspop();
+    if (capacity)
+        onward_aspush((value_t)chan_setup(addr, capacity, multi));
+}
+
+/** Allocate a channel for one sender and one receiver holding at least the
+ * given number of cells from the dictionary */
+defcode("chan", chan, &chan_init, 0u) {
+    uvalue_t capacity = chan_capacity(onward_aspop());
+    value_t pad       = (value_t)((sizeof(value_t) - ((uvalue_t)here % sizeof(value_t))) % sizeof(value_t));
+    value_t addr      = 0;
+    if (capacity)
+        addr = onward_allot(pad + (value_t)(sizeof(chan_t) + (capacity * sizeof(chan_slot_t))));
+    if (addr)
+        onward_aspush((value_t)chan_setup((void*)(addr + pad), capacity, 0));
+}
+
+/** Allocate a channel for any number of senders and receivers holding at least
+ * the given number of cells from the dictionary */
+defcode("mpmc-chan", mpmc_chan, &chan, 0u) {
+    chan_code();
+    ((chan_t*)onward_aspeek(0))->multi = 1;
+}
+
+/** Send a cell, waiting until there is room for it */
+defcode("chan-send", chan_send, &mpmc_chan, 0u) {
+    chan_t* chan = (chan_t*)onward_aspop();
+    value_t val  = onward_aspop();
+    chan_put_all(chan, &val, 1, 1);
+}
+
+/** Receive a cell, waiting until one has been sent */
+defcode("chan-recv", chan_recv, &chan_send, 0u) {
+    chan_t* chan = (chan_t*)onward_aspop();
+    value_t val;
+    chan_get_all(chan, &val, 1, 1);
+    onward_aspush(val);
+}
+
+/** Send a cell if there is room for it, pushing 1 if it was sent otherwise 0 */
+defcode("chan-send?", chan_try_send, &chan_recv, 0u) {
+    chan_t* chan = (chan_t*)onward_aspop();
+    value_t val  = onward_aspop();
+    onward_aspush(chan_put(chan, &val, 1, 1));
+}
+
+/** Receive a cell if one has been sent, pushing the cell and 1 if it was
+ * received otherwise 0 and 0 */
+defcode("chan-recv?", chan_try_recv, &chan_try_send, 0u) {
+    chan_t* chan = (chan_t*)onward_aspop();
+    value_t val  = 0;
+    value_t got  = chan_get(chan, &val, 1, 1);
+    onward_aspush(val);
+    onward_aspush(got);
+}
+
+/** Send the given number of cells of an array, moving as many at a time as
+ * there is room for until all of them are sent */
+defcode("chan-send-n", chan_send_n, &chan_try_recv, 0u) {
+    chan_t* chan  = (chan_t*)onward_aspop();
+    value_t count = onward_aspop();
+    value_t* data = (value_t*)onward_aspop();
+    chan_put_all(chan, data, count, 0);
+}
+
+/** Receive the given number of cells into an array, moving as many at a time
+ * as have been sent until all of them are received */
+defcode("chan-recv-n", chan_recv_n, &chan_send_n, 0u) {
+    chan_t* chan  = (chan_t*)onward_aspop();
+    value_t count = onward_aspop();
+    value_t* data = (value_t*)onward_aspop();
+    chan_get_all(chan, data, count, 0);
+}
+
+/** Send up to the given number of cells of an array without waiting, pushing
+ * the number sent */
+defcode("chan-send-n?", chan_try_send_n, &chan_recv_n, 0u) {
+    chan_t* chan  = (chan_t*)onward_aspop();
+    value_t count = onward_aspop();
+    value_t* data = (value_t*)onward_aspop();
+    onward_aspush(chan_put(chan, data, count, 0));
+}
+
+/** Receive up to the given number of cells into an array without waiting,
+ * pushing the number received */
+defcode("chan-recv-n?", chan_try_recv_n, &chan_try_send_n, 0u) {
+    chan_t* chan  = (chan_t*)onward_aspop();
+    value_t count = onward_aspop();
+    value_t* data = (value_t*)onward_aspop();
+    onward_aspush(chan_get(chan, data, count, 0));
+}
+
+/** Send the address and length of a string as one message, waiting until
+ * there is room for both. Only the address and length are sent so the bytes
+ * must not change until the receiver is done with them. */
+defcode("chan-send-slice", chan_send_slice, &chan_try_recv_n, 0u) {
+    chan_t* chan = (chan_t*)onward_aspop();
+    value_t slice[2];
+    slice[1] = onward_aspop();
+    slice[0] = onward_aspop();
+    chan_put_all(chan, slice, 2, 1);
+}
+
+/** Receive the address and length of a string sent as one message, waiting
+ * until both have been sent. Every message of the channel must be a string
+ * for the cells to pair up. */
+defcode("chan-recv-slice", chan_recv_slice, &chan_send_slice, 0u) {
+    chan_t* chan = (chan_t*)onward_aspop();
+    value_t slice[2];
+    chan_get_all(chan, slice, 2, 1);
+    onward_aspush(slice[0]);
+    onward_aspush(slice[1]);
+}
+
+/* Helper C Functions
+ *****************************************************************************/
+/* Round the number of cells up to a power of 2 of at least 2 slots. Throws and
+ * returns 0 if the number is not positive or the channel would not fit in
+ * memory. */
+static uvalue_t chan_capacity(value_t limit) {
+    uvalue_t capacity = 2u;
+    if ((limit <= 0) || ((uvalue_t)limit > CHAN_MAX_SLOTS)) {
+        onward_throw(ERR_BAD_SIZE);
+        return 0;
+    }
+    while (capacity < (uvalue_t)limit)
+        capacity <<= 1u;
+    return capacity;
+}
+
+static chan_t* chan_setup(void* addr, uvalue_t capacity, value_t multi) {
+    chan_t* chan = (chan_t*)addr;
+    uvalue_t i;
+    chan->mask       = capacity - 1u;
+    chan->multi      = (multi != 0);
+    chan->tail       = 0;
+    chan->head_seen  = 0;
+    chan->head       = 0;
+    chan->tail_seen  = 0;
+    for (i = 0; i <= chan->mask; i++) {
+        chan->slots[i].seq = i;
+        chan->slots[i].val = 0;
+    }
+    return chan;
+}
+
+/* Send up to the given number of cells, or none unless all of them fit, and
+ * return the number sent. Senders of a channel of many threads claim a run of
+ * slots that are free to write by advancing the tail, then publish each slot
+ * once it is written. */
+static value_t chan_put(chan_t* chan, value_t const* cells, value_t count, value_t all) {
+    uvalue_t pos = __atomic_load_n(&(chan->tail), __ATOMIC_RELAXED);
+    value_t i, ready = 0;
+    if (count <= 0) {
+        return 0;
+    } else if (!chan->multi) {
+        ready = (value_t)(chan->mask + 1u - (pos - chan->head_seen));
+        if (ready < count) {
+            chan->head_seen = __atomic_load_n(&(chan->head), __ATOMIC_ACQUIRE);
+            ready = (value_t)(chan->mask + 1u - (pos - chan->head_seen));
+        }
+        if (ready > count)
+            ready = count;
+        if (all && (ready < count))
+            return 0;
+        for (i = 0; i < ready; i++)
+            chan->slots[(pos + (uvalue_t)i) & chan->mask].val = cells[i];
+        __atomic_store_n(&(chan->tail), pos + (uvalue_t)ready, __ATOMIC_RELEASE);
+        return ready;
+    }
+    for (;;) {
+        value_t stale = 0;
+        for (ready = 0; ready < count; ready++) {
+            uvalue_t at  = pos + (uvalue_t)ready;
+            value_t diff = (value_t)(__atomic_load_n(&(chan->slots[at & chan->mask].seq), __ATOMIC_ACQUIRE) - at);
+            /* The slot is still being read if behind, or was claimed by
+             * another sender if ahead */
+            if (diff != 0) {
+                stale = (diff > 0);
+                break;
+            }
+        }
+        if (stale) {
+            pos = __atomic_load_n(&(chan->tail), __ATOMIC_RELAXED);
+        } else if ((ready == 0) || (all && (ready < count))) {
+            return 0;
+        } else if (__atomic_compare_exchange_n(&(chan->tail), &pos, pos + (uvalue_t)ready, 0,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            for (i = 0; i < ready; i++) {
+                chan_slot_t* slot = &(chan->slots[(pos + (uvalue_t)i) & chan->mask]);
+                slot->val = cells[i];
+                __atomic_store_n(&(slot->seq), pos + (uvalue_t)i + 1u, __ATOMIC_RELEASE);
+            }
+            return ready;
+        }
+    }
+}
+
+/* Receive up to the given number of cells, or none unless all of them have
+ * been sent, and return the number received. Receivers of a channel of many
+ * threads claim a run of written slots by advancing the head, then free each
+ * slot for the senders one lap later. */
+static value_t chan_get(chan_t* chan, value_t* cells, value_t count, value_t all) {
+    uvalue_t pos = __atomic_load_n(&(chan->head), __ATOMIC_RELAXED);
+    value_t i, ready = 0;
+    if (count <= 0) {
+        return 0;
+    } else if (!chan->multi) {
+        ready = (value_t)(chan->tail_seen - pos);
+        if (ready < count) {
+            chan->tail_seen = __atomic_load_n(&(chan->tail), __ATOMIC_ACQUIRE);
+            ready = (value_t)(chan->tail_seen - pos);
+        }
+        if (ready > count)
+            ready = count;
+        if (all && (ready < count))
+            return 0;
+        for (i = 0; i < ready; i++)
+            cells[i] = chan->slots[(pos + (uvalue_t)i) & chan->mask].val;
+        __atomic_store_n(&(chan->head), pos + (uvalue_t)ready, __ATOMIC_RELEASE);
+        return ready;
+    }
+    for (;;) {
+        value_t stale = 0;
+        for (ready = 0; ready < count; ready++) {
+            uvalue_t at  = pos + (uvalue_t)ready;
+            value_t diff = (value_t)(__atomic_load_n(&(chan->slots[at & chan->mask].seq), __ATOMIC_ACQUIRE) - (at + 1u));
+            /* The slot is not written yet if behind, or was claimed by
+             * another receiver if ahead */
+            if (diff != 0) {
+                stale = (diff > 0);
+                break;
+            }
+        }
+        if (stale) {
+            pos = __atomic_load_n(&(chan->head), __ATOMIC_RELAXED);
+        } else if ((ready == 0) || (all && (ready < count))) {
+            return 0;
+        } else if (__atomic_compare_exchange_n(&(chan->head), &pos, pos + (uvalue_t)ready, 0,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            for (i = 0; i < ready; i++) {
+                chan_slot_t* slot = &(chan->slots[(pos + (uvalue_t)i) & chan->mask]);
+                cells[i] = slot->val;
+                __atomic_store_n(&(slot->seq), pos + (uvalue_t)i + chan->mask + 1u, __ATOMIC_RELEASE);
+            }
+            return ready;
+        }
+    }
+}
+
+/* Send all of the cells, yielding to other threads while the channel is full.
+ * A whole message is only sent once there is room for all of it so it is not
+ * interleaved with the cells of other senders. */
+static void chan_put_all(chan_t* chan, value_t const* cells, value_t count, value_t whole) {
+    while (count > 0) {
+        value_t sent = chan_put(chan, cells, count, whole);
+        if (!sent)
+            sched_yield();
+        cells += sent;
+        count -= sent;
+    }
+}
+
+/* Receive all of the cells, yielding to other threads while the channel is
+ * empty. A whole message is only received once all of it has been sent. */
+static void chan_get_all(chan_t* chan, value_t* cells, value_t count, value_t whole) {
+    while (count > 0) {
+        value_t got = chan_get(chan, cells, count, whole);
+        if (!got)
+            sched_yield();
+        cells += got;
+        count -= got;
+    }
+}
@@ -0,0 +1,243 @@
+#include "onward.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Every built-in word is declared so its address can be matched to the name
+ * of its C definition. The list is generated from the sources. */
+#define META_NAME(c_name) extern const word_t c_name;
+#include "onward_names.h"
+#undef META_NAME
+
+typedef struct {
+    word_t const* word;
+    char const* name;
+} meta_builtin_t;
+
+static const meta_builtin_t Builtins[] = {
+#define META_NAME(c_name) { &c_name, #c_name },
+#include "onward_names.h"
+#undef META_NAME
+};
+
+/** A range of the word buffer emitted as one array. Words hold their name,
+ * header, and instructions and are emitted read-only. The memory between
+ * words holds data and is emitted writable. */
+typedef struct {
+    value_t start;
+    value_t end;
+    /** The word whose header is in the range or 0u (NULL) for data */
+    word_t const* word;
+    /** Whether the range is reachable from the roots */
+    value_t keep;
+} meta_obj_t;
+
+static meta_obj_t* Objects = NULL;
+static value_t Object_Count = 0;
+
+static char const* meta_builtin(value_t val) {
+    size_t i;
+    for (i = 0; i < sizeof(Builtins)/sizeof(Builtins[0]); i++) {
+        if ((value_t)Builtins[i].word == val)
+            return Builtins[i].name;
+    }
+    return NULL;
+}
+
+static value_t meta_find(value_t addr) {
+    value_t i;
+    for (i = 0; i < Object_Count; i++) {
+        if ((addr >= Objects[i].start) && (addr < Objects[i].end))
+            return i;
+    }
+    /* A pointer to the end of the word buffer belongs to the last range */
+    return ((addr == here) && Object_Count) ? (Object_Count - 1) : -1;
+}
+
+static void meta_add(value_t start, value_t end, word_t const* word) {
+    if (start < end) {
+        Objects[Object_Count].start = start;
+        Objects[Object_Count].end   = end;
+        Objects[Object_Count].word  = word;
+        Objects[Object_Count].keep  = 0;
+        Object_Count++;
+    }
+}
+
+/* Split the word buffer into words and the data between them. Returns 0 if a
+ * word cannot be emitted. */
+static value_t meta_split(void) {
+    word_t const* word;
+    word_t const** words;
+    value_t count = 0, i, prev = hbase;
+    for (word = (word_t const*)latest; word && ((value_t)word >= hbase) && ((value_t)word < here); word = word->link)
+        count++;
+    words   = (word_t const**)malloc((size_t)(count + 1) * sizeof(word_t*));
+    Objects = (meta_obj_t*)malloc((size_t)(2 * count + 1) * sizeof(meta_obj_t));
+    if (!words || !Objects)
+        return 0;
+    for (word = (word_t const*)latest, i = count; i > 0; word = word->link)
+        words[--i] = word;
+    for (i = 0; i < count; i++) {
+        value_t const* code = words[i]->code;
+        value_t len = 0;
+        if ((words[i]->flags & F_PRIMITIVE_MSK) || onward_token_code(words[i]) ||
+            (code != (value_t const*)(words[i] + 1))) {
+            fprintf(stderr, "%s: only colon definitions can be compiled\n", words[i]->name);
+            return 0;
+        }
+        /* The instructions end at a return, operands are skipped over */
+        while (((value_t)(code + len) < here) && code[len]) {
+            len += onward_operand(code[len]) ? 2 : 1;
+        }
+        meta_add(prev, (value_t)words[i]->name, NULL);
+        prev = (value_t)(code + len + 1);
+        if (prev > here)
+            prev = here;
+        meta_add((value_t)words[i]->name, prev, words[i]);
+    }
+    meta_add(prev, here, NULL);
+    free(words);
+    return 1;
+}
+
+/* Keep the ranges reachable from the named roots, or everything if there are
+ * none. Links between words do not make them reachable. */
+static value_t meta_shake(char* roots) {
+    value_t i, changed = 1;
+    char* name;
+    if (!roots || !*roots) {
+        for (i = 0; i < Object_Count; i++)
+            Objects[i].keep = 1;
+        return 1;
+    }
+    for (name = strtok(roots, " \t"); name; name = strtok(NULL, " \t")) {
+        for (i = 0; i < Object_Count; i++) {
+            if (Objects[i].word && !strcmp(Objects[i].word->name, name))
+                break;
+        }
+        if (i == Object_Count) {
+            fprintf(stderr, "%s: root is not a word in the word buffer\n", name);
+            return 0;
+        }
+        Objects[i].keep = 1;
+    }
+    while (changed) {
+        changed = 0;
+        for (i = 0; i < Object_Count; i++) {
+            value_t* cell;
+            if (!Objects[i].keep)
+                continue;
+            for (cell = (value_t*)Objects[i].start; (value_t)cell < Objects[i].end; cell++) {
+                value_t target;
+                if (Objects[i].word && (cell == (value_t*)&(Objects[i].word->link)))
+                    continue;
+                target = meta_find(*cell);
+                if ((target >= 0) && !Objects[target].keep) {
+                    Objects[target].keep = 1;
+                    changed = 1;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+/* Print a cell as a C expression, relocating addresses in the word buffer */
+static void meta_cell(FILE* out, value_t val) {
+    value_t target = meta_find(val);
+    char const* name;
+    if (target >= 0) {
+        value_t offset = val - Objects[target].start;
+        if (offset % (value_t)sizeof(value_t))
+            fprintf(out, "(value_t)((char const*)Meta_%zd + %zd)", (intptr_t)target, (intptr_t)offset);
+        else
+            fprintf(out, "(value_t)&Meta_%zd[%zd]", (intptr_t)target, (intptr_t)(offset / (value_t)sizeof(value_t)));
+    } else if ((name = meta_builtin(val))) {
+        fprintf(out, "W(%s)", name);
+    } else if (val == INTPTR_MIN) {
+        fprintf(out, "(-%zd-1)", INTPTR_MAX);
+    } else {
+        fprintf(out, "%zd", (intptr_t)val);
+    }
+}
+
+/* Print a pointer to the header of a word */
+static void meta_word(FILE* out, word_t const* word) {
+    value_t target = word ? meta_find((value_t)word) : -1;
+    char const* name;
+    if (target >= 0)
+        fprintf(out, "(word_t const*)&Meta_%zd[%zd]", (intptr_t)target,
+                (intptr_t)(((value_t)word - Objects[target].start) / (value_t)sizeof(value_t)));
+    else if (word && (name = meta_builtin((value_t)word)))
+        fprintf(out, "&%s", name);
+    else
+        fprintf(out, "0u");
+}
+
+static void meta_emit(FILE* out, char const* files) {
+    word_t const* base = NULL;
+    word_t const* prev = NULL;
+    value_t i;
+    size_t j;
+    fprintf(out, "/* Generated by the metacompiler from %s, do not edit */\n", files);
+    fprintf(out, "#include \"onward.h\"\n\n");
+    for (j = 0; j < sizeof(Builtins)/sizeof(Builtins[0]); j++)
+        fprintf(out, "extern const word_t %s;\n", Builtins[j].name);
+    fprintf(out, "\n");
+    for (i = 0; i < Object_Count; i++) {
+        if (Objects[i].keep)
+            fprintf(out, "static %svalue_t Meta_%zd[%zd];\n", (Objects[i].word ? "const " : ""), (intptr_t)i,
+                    (intptr_t)((Objects[i].end - Objects[i].start + sizeof(value_t) - 1) / sizeof(value_t)));
+    }
+    /* The first word links to the built-in words */
+    for (i = 0; i < Object_Count; i++) {
+        if (Objects[i].word) {
+            base = Objects[i].word->link;
+            break;
+        }
+    }
+    for (i = 0; i < Object_Count; i++) {
+        value_t const* cell;
+        value_t const* end = (value_t const*)Objects[i].end;
+        if (!Objects[i].keep)
+            continue;
+        if (Objects[i].word)
+            fprintf(out, "\n/* %s */", Objects[i].word->name);
+        fprintf(out, "\nstatic %svalue_t Meta_%zd[] = {", (Objects[i].word ? "const " : ""), (intptr_t)i);
+        for (cell = (value_t const*)Objects[i].start; cell < end; cell++) {
+            fprintf(out, "%s", (((cell - (value_t const*)Objects[i].start) % 4) ? " " : "\n    "));
+            /* Words are linked to the previous word that was kept */
+            if (Objects[i].word && (cell == (value_t const*)&(Objects[i].word->link))) {
+                fprintf(out, "(value_t)");
+                meta_word(out, prev ? prev : base);
+            } else {
+                meta_cell(out, *cell);
+            }
+            fprintf(out, ",");
+        }
+        fprintf(out, "\n};\n");
+        if (Objects[i].word)
+            prev = Objects[i].word;
+    }
+    fprintf(out, "\nword_t const* const Onward_Image = ");
+    meta_word(out, prev ? prev : base);
+    fprintf(out, ";\n");
+}
+
+int onward_meta(char const* path, char* roots, char const* files) {
+    FILE* out;
+    if (here % (value_t)sizeof(value_t))
+        here += (value_t)sizeof(value_t) - (here % (value_t)sizeof(value_t));
+    if (!meta_split() || !meta_shake(roots))
+        return 1;
+    out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return 1;
+    }
+    meta_emit(out, files);
+    fclose(out);
+    free(Objects);
+    return 0;
+}
@@ -0,0 +1,293 @@
+#include "onward.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/* The number of cells in the stacks of each worker thread */
+#define PAR_STACK_SZ 256
+
+/* The number of elements a worker takes from its range at a time */
+#define PAR_GRAIN 64u
+
+/* The maximum number of threads in the worker pool */
+#define PAR_MAX_THREADS 64
+
+/* Ranges are packed into a single word so they can be updated with one
+ * compare-and-swap. The low half holds the start and the high half the end. */
+#define RANGE(lo, hi)   (((uint64_t)(hi) << 32u) | (uint64_t)(lo))
+#define RANGE_LO(range) ((uint32_t)(range))
+#define RANGE_HI(range) ((uint32_t)((range) >> 32u))
+
+typedef struct {
+    pthread_t thread;
+    /* The last job this worker has seen started */
+    value_t generation;
+    /* The remaining elements this worker owns, as a packed range */
+    uint64_t range;
+    /* The reduction of the elements processed by this worker */
+    value_t result;
+    value_t arg_stack[PAR_STACK_SZ];
+    value_t ret_stack[PAR_STACK_SZ];
+} par_worker_t;
+
+typedef struct {
+    value_t* data;
+    word_t const* word;
+    value_t init;
+    value_t reduce;
+    value_t latest;
+    value_t here;
+    value_t hbase;
+    value_t hsize;
+} par_job_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    /* Incremented each time a job is started */
+    value_t generation;
+    /* The number of threads that take part in a job */
+    value_t running;
+    /* The number of threads that have been created, including the caller */
+    value_t count;
+    /* The number of threads still working on the current job */
+    value_t pending;
+    /* Set while a job is running so overlapping calls run sequentially */
+    value_t active;
+    /* The first error thrown by the word of the current job, 0 if none */
+    value_t error;
+    par_job_t job;
+    par_worker_t workers[PAR_MAX_THREADS];
+} Pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    0, 0, 0, 0, 0, 0, { 0u, 0u, 0, 0, 0, 0, 0, 0 }, { { 0 } }
+};
+
+static void par_resize(value_t count);
+static void par_execute(value_t* data, value_t count, word_t const* word, value_t init, value_t reduce);
+static void par_fail(value_t code);
+static void* par_thread(void* arg);
+
+/** Set the number of threads used by par-map and par-reduce */
+defcode("par-threads", par_threads, &stats, 0u) {
+    par_resize(onward_aspop());
+}
+
+/** Replace each cell of an array with the result of executing a word on it,
+ * splitting the array across the worker pool */
+defcode("par-map", par_map, &par_threads, 0u) {
+    word_t const* word = (word_t const*)onward_aspop();
+    value_t count      = onward_aspop();
+    value_t* data      = (value_t*)onward_aspop();
+    par_execute(data, count, word, 0, 0);
+}
+
+/** Combine the cells of an array with a word taking two cells and returning
+ * one, starting from an initial value. The word must be associative and
+ * commutative and the initial value must be its identity. */
+defcode("par-reduce", par_reduce, &par_map, 0u) {
+    word_t const* word = (word_t const*)onward_aspop();
+    value_t init       = onward_aspop();
+    value_t count      = onward_aspop();
+    value_t* data      = (value_t*)onward_aspop();
+    par_execute(data, count, word, init, 1);
+}
+
+/* Helper C Functions
+ *****************************************************************************/
+static void par_resize(value_t count) {
+    if (count < 1) count = 1;
+    if (count > PAR_MAX_THREADS) count = PAR_MAX_THREADS;
+    pthread_mutex_lock(&Pool.lock);
+    /* Worker 0 is always the calling thread so it has no thread of its own */
+    if (Pool.count == 0)
+        Pool.count = 1;
+    while (Pool.count < count) {
+        par_worker_t* worker = &(Pool.workers[Pool.count]);
+        /* A new worker waits for the next job rather than the last one */
+        worker->generation = Pool.generation;
+        if (0 != pthread_create(&(worker->thread), NULL, &par_thread, worker))
+            break;
+        Pool.count++;
+    }
+    Pool.running = (count < Pool.count) ? count : Pool.count;
+    pthread_mutex_unlock(&Pool.lock);
+}
+
+/* Take the next block of elements from the worker's range or, when empty,
+ * steal half of the remaining elements of another worker */
+static int par_take(par_worker_t* self, uint32_t* lo, uint32_t* hi) {
+    value_t i;
+    uint64_t range = __atomic_load_n(&(self->range), __ATOMIC_ACQUIRE);
+    /* Stop taking elements once the word has failed on any of them */
+    if (__atomic_load_n(&(Pool.error), __ATOMIC_ACQUIRE))
+        return 0;
+    while (RANGE_LO(range) < RANGE_HI(range)) {
+        uint32_t end = RANGE_LO(range) + PAR_GRAIN;
+        if (end > RANGE_HI(range)) end = RANGE_HI(range);
+        if (__atomic_compare_exchange_n(&(self->range), &range, RANGE(end, RANGE_HI(range)),
+                                        0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *lo = RANGE_LO(range);
+            *hi = end;
+            return 1;
+        }
+    }
+    for (i = 1; i < Pool.running; i++) {
+        par_worker_t* victim = &(Pool.workers[((self - Pool.workers) + i) % Pool.running]);
+        range = __atomic_load_n(&(victim->range), __ATOMIC_ACQUIRE);
+        while (RANGE_LO(range) < RANGE_HI(range)) {
+            uint32_t mid = RANGE_LO(range) + ((RANGE_HI(range) - RANGE_LO(range)) / 2u);
+            if (__atomic_compare_exchange_n(&(victim->range), &range, RANGE(RANGE_LO(range), mid),
+                                            0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                /* Keep the stolen elements beyond the first block for later */
+                *lo = mid;
+                *hi = (RANGE_HI(range) - mid > PAR_GRAIN) ? mid + PAR_GRAIN : RANGE_HI(range);
+                __atomic_store_n(&(self->range), RANGE(*hi, RANGE_HI(range)), __ATOMIC_RELEASE);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Apply the word of the job to the elements in the given range. The word is
+ * run by catch so that an error it throws on any thread stops at the element
+ * and is returned in code for the thread that started the job to pass on. */
+static value_t par_apply(par_job_t const* job, value_t lo, value_t hi, value_t acc, value_t* code) {
+    for (*code = 0; lo < hi; lo++) {
+        if (job->reduce)
+            onward_aspush(acc);
+        onward_aspush(job->data[lo]);
+        onward_aspush((value_t)job->word);
+        onward_exec(&_catch);
+        *code = onward_aspop();
+        if (*code) {
+            (void)onward_aspop();
+            if (job->reduce)
+                (void)onward_aspop();
+            break;
+        } else if (job->reduce) {
+            acc = onward_aspop();
+        } else {
+            job->data[lo] = onward_aspop();
+        }
+    }
+    return acc;
+}
+
+/* Record the first error of the job */
+static void par_fail(value_t code) {
+    value_t none = 0;
+    (void)__atomic_compare_exchange_n(&(Pool.error), &none, code, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/* Work on the job until every element is taken. Anything else thrown on the
+ * way, such as a stack overflow, also stops the job. */
+static void par_work(par_worker_t* self, par_job_t const* job) {
+    volatile value_t acc = job->init;
+    value_t code;
+    uint32_t lo, hi;
+    onward_frame_t frame;
+    onward_frame_push(&frame);
+    if (0 == setjmp(frame.jump)) {
+        while (par_take(self, &lo, &hi)) {
+            acc = par_apply(job, lo, hi, acc, &code);
+            if (code)
+                par_fail(code);
+        }
+    }
+    onward_frame_pop(&frame);
+    if (frame.code)
+        par_fail(frame.code);
+    self->result = acc;
+}
+
+static void* par_thread(void* arg) {
+    par_worker_t* self = (par_worker_t*)arg;
+    onward_init_t init = {
+        self->arg_stack, sizeof(self->arg_stack),
+        self->ret_stack, sizeof(self->ret_stack),
+        NULL, 0, NULL, NULL, NULL
+    };
+    onward_init(&init);
+    pthread_mutex_lock(&Pool.lock);
+    for (;;) {
+        while (self->generation == Pool.generation)
+            pthread_cond_wait(&Pool.start, &Pool.lock);
+        self->generation = Pool.generation;
+        /* Workers beyond the requested count sit the job out */
+        if ((self - Pool.workers) < Pool.running) {
+            pthread_mutex_unlock(&Pool.lock);
+            /* Share the dictionary of the thread that started the job */
+            latest = Pool.job.latest;
+            here   = Pool.job.here;
+            hbase  = Pool.job.hbase;
+            hsize  = Pool.job.hsize;
+            par_work(self, &Pool.job);
+            pthread_mutex_lock(&Pool.lock);
+            if (0 == --Pool.pending)
+                pthread_cond_signal(&Pool.done);
+        }
+    }
+    return NULL;
+}
+
+static void par_execute(value_t* data, value_t count, word_t const* word, value_t init, value_t reduce) {
+    par_job_t job = { data, word, init, reduce, latest, here, hbase, hsize };
+    value_t i, code, result = init;
+    if (Pool.count == 0)
+        par_resize(sysconf(_SC_NPROCESSORS_ONLN));
+    pthread_mutex_lock(&Pool.lock);
+    /* Run on the calling thread alone when the pool is already busy, such as
+     * when called from a worker, when there is too little work to share, when
+     * the count does not fit in the halves of a packed range, or when the
+     * evaluation is limited as the limits only apply to the calling thread */
+    if (Pool.active || (Pool.running == 1) || (count <= (value_t)PAR_GRAIN) ||
+        ((uint64_t)count > (uint64_t)UINT32_MAX) || onward_limited()) {
+        pthread_mutex_unlock(&Pool.lock);
+        result = par_apply(&job, 0, count, init, &code);
+        if (code) {
+            onward_throw(code);
+            return;
+        }
+    } else {
+        /* Divide the array evenly and wake the workers */
+        Pool.job = job;
+        for (i = 0; i < Pool.running; i++) {
+            value_t lo = (count * i) / Pool.running;
+            value_t hi = (count * (i + 1)) / Pool.running;
+            __atomic_store_n(&(Pool.workers[i].range), RANGE(lo, hi), __ATOMIC_RELEASE);
+        }
+        Pool.active  = 1;
+        Pool.error   = 0;
+        Pool.pending = Pool.running - 1;
+        Pool.generation++;
+        pthread_cond_broadcast(&Pool.start);
+        pthread_mutex_unlock(&Pool.lock);
+        /* Take part in the job and then wait for the others to finish, even
+         * if an error stops this thread, before passing the error on */
+        par_work(&(Pool.workers[0]), &job);
+        pthread_mutex_lock(&Pool.lock);
+        while (Pool.pending > 0)
+            pthread_cond_wait(&Pool.done, &Pool.lock);
+        code        = Pool.error;
+        Pool.error  = 0;
+        Pool.active = 0;
+        pthread_mutex_unlock(&Pool.lock);
+        if (code) {
+            onward_throw(code);
+            return;
+        }
+        /* Combine the results of each worker */
+        for (i = 0; reduce && (i < Pool.running); i++) {
+            onward_aspush(result);
+            onward_aspush(Pool.workers[i].result);
+            onward_exec(word);
+            result = onward_aspop();
+        }
+    }
+    if (reduce)
+        onward_aspush(result);
+}
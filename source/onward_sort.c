@@ -0,0 +1,185 @@
+#include "onward.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Ranges with fewer elements than this are finished with an insertion sort */
+#define SORT_SMALL 16
+
+/* The number of bits in each digit of the radix sort */
+#define RADIX_BITS 8u
+
+/* The number of buckets for each digit of the radix sort */
+#define RADIX_SIZE (1u << RADIX_BITS)
+
+static value_t sort_less(word_t const* word, value_t lval, value_t rval);
+static void sort_range(value_t* data, value_t count, word_t const* word, value_t depth);
+static void sort_insertion(value_t* data, value_t count, word_t const* word);
+static void sort_heap(value_t* data, value_t count, word_t const* word);
+static value_t sort_partition(value_t* data, value_t count, word_t const* word);
+
+/** Sort an array of cells in place using a word that takes two cells and
+ * returns non-zero if the second item should come before the top item */
+defcode("sort", sort, &table_each, 0u) {
+    word_t const* word = (word_t const*)onward_aspop();
+    value_t count      = onward_aspop();
+    value_t* data      = (value_t*)onward_aspop();
+    value_t depth      = 0;
+    value_t i;
+    /* Fall back to heap sort after 2*log2(n) levels of partitioning */
+    for (i = count; i > 1; i >>= 1)
+        depth += 2;
+    sort_range(data, count, word, depth);
+}
+
+/** Sort an array of cells in place in ascending order. The cells are treated
+ * as signed values and no comparison word is called. */
+defcode("radix-sort", radix_sort, &sort, 0u) {
+    value_t count = onward_aspop();
+    value_t* data = (value_t*)onward_aspop();
+    uvalue_t sign = (uvalue_t)1u << (CELL_BITS - 1u);
+    value_t counts[sizeof(value_t)][RADIX_SIZE];
+    value_t* temp;
+    value_t *src = data, *dst;
+    value_t i;
+    uvalue_t digit, shift;
+    if (count < 2)
+        return;
+    temp = (value_t*)malloc((size_t)count * sizeof(value_t));
+    if (!temp) {
+        sort_range(data, count, &lt, 2 * (value_t)CELL_BITS);
+        return;
+    }
+    dst = temp;
+    /* Count the values of every digit in a single pass. The sign bit is
+     * flipped so negative values order before positive ones. */
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < count; i++) {
+        uvalue_t key = (uvalue_t)data[i] ^ sign;
+        for (digit = 0; digit < sizeof(value_t); digit++)
+            counts[digit][(key >> (digit * RADIX_BITS)) & (RADIX_SIZE - 1u)]++;
+    }
+    for (digit = 0; digit < sizeof(value_t); digit++) {
+        value_t* bucket = counts[digit];
+        value_t offset = 0;
+        shift = digit * RADIX_BITS;
+        /* Skip digits that are the same for every value */
+        if (bucket[(((uvalue_t)data[0] ^ sign) >> shift) & (RADIX_SIZE - 1u)] == count)
+            continue;
+        for (i = 0; i < (value_t)RADIX_SIZE; i++) {
+            value_t size = bucket[i];
+            bucket[i] = offset;
+            offset   += size;
+        }
+        for (i = 0; i < count; i++) {
+            uvalue_t key = (uvalue_t)src[i] ^ sign;
+            dst[bucket[(key >> shift) & (RADIX_SIZE - 1u)]++] = src[i];
+        }
+        /* The sorted digit becomes the source of the next pass */
+        dst = src;
+        src = (src == data) ? temp : data;
+    }
+    if (src != data)
+        memcpy(data, src, (size_t)count * sizeof(value_t));
+    free(temp);
+}
+
+/* Helper C Functions
+ *****************************************************************************/
+/* The ordering words are compared directly, other primitives are called
+ * without starting an interpreter loop */
+static value_t sort_less(word_t const* word, value_t lval, value_t rval) {
+    if (word == &lt)
+        return (lval < rval);
+    if (word == &gt)
+        return (lval > rval);
+    onward_aspush(lval);
+    onward_aspush(rval);
+    if (word->flags & F_PRIMITIVE_MSK)
+        ((primitive_t)word->code)();
+    else
+        onward_exec(word);
+    return onward_aspop();
+}
+
+static void sort_range(value_t* data, value_t count, word_t const* word, value_t depth) {
+    while (count > SORT_SMALL) {
+        value_t split;
+        if (depth-- == 0) {
+            sort_heap(data, count, word);
+            return;
+        }
+        /* Recurse into the smaller side so the C stack stays shallow */
+        split = sort_partition(data, count, word);
+        if (split < (count - split)) {
+            sort_range(data, split, word, depth);
+            data  += split;
+            count -= split;
+        } else {
+            sort_range(data + split, count - split, word, depth);
+            count = split;
+        }
+    }
+    sort_insertion(data, count, word);
+}
+
+static void sort_insertion(value_t* data, value_t count, word_t const* word) {
+    value_t i, j;
+    for (i = 1; i < count; i++) {
+        value_t val = data[i];
+        for (j = i; (j > 0) && sort_less(word, val, data[j-1]); j--)
+            data[j] = data[j-1];
+        data[j] = val;
+    }
+}
+
+static void sort_sift(value_t* data, value_t root, value_t count, word_t const* word) {
+    value_t val = data[root];
+    value_t child;
+    while ((child = (2 * root) + 1) < count) {
+        if (((child + 1) < count) && sort_less(word, data[child], data[child+1]))
+            child++;
+        if (!sort_less(word, val, data[child]))
+            break;
+        data[root] = data[child];
+        root = child;
+    }
+    data[root] = val;
+}
+
+static void sort_heap(value_t* data, value_t count, word_t const* word) {
+    value_t i;
+    for (i = (count / 2) - 1; i >= 0; i--)
+        sort_sift(data, i, count, word);
+    for (i = count - 1; i > 0; i--) {
+        value_t top = data[0];
+        data[0] = data[i];
+        data[i] = top;
+        sort_sift(data, 0, i, word);
+    }
+}
+
+/* Partition around the median of the first, middle and last elements,
+ * returning the number of elements in the lower partition. The scans are
+ * bounded so an inconsistent comparison word cannot leave the array. */
+static value_t sort_partition(value_t* data, value_t count, word_t const* word) {
+    value_t mid = count / 2, last = count - 1;
+    value_t i = -1, j = count;
+    value_t pivot, temp;
+    if (sort_less(word, data[mid], data[0])) {
+        temp = data[0]; data[0] = data[mid]; data[mid] = temp;
+    }
+    if (sort_less(word, data[last], data[mid])) {
+        temp = data[mid]; data[mid] = data[last]; data[last] = temp;
+        if (sort_less(word, data[mid], data[0])) {
+            temp = data[0]; data[0] = data[mid]; data[mid] = temp;
+        }
+    }
+    pivot = data[mid];
+    for (;;) {
+        do i++; while ((i < last) && sort_less(word, data[i], pivot));
+        do j--; while ((j > 0) && sort_less(word, pivot, data[j]));
+        if (i >= j)
+            return (j + 1);
+        temp = data[i]; data[i] = data[j]; data[j] = temp;
+    }
+}
@@ -0,0 +1,126 @@
+#include "onward.h"
+#include <string.h>
+
+static char const* slice_find(char const* str, value_t len, char const* sub, value_t sublen);
+
+/** Convert a NUL-terminated string to an address and length */
+defcode("slice", slice, &radix_sort, 0u) {
+    char const* str = (char const*)onward_aspeek(0);
+    onward_aspush((value_t)strlen(str));
+}
+
+/** Advance the start of a string by the given number of characters, at most
+ * its length */
+defcode("/string", slash_string, &slice, 0u) {
+    value_t count = onward_aspop();
+    value_t len   = onward_aspop();
+    value_t addr  = onward_aspop();
+    if (count > len)
+        count = len;
+    else if (count < 0)
+        count = 0;
+    onward_aspush(addr + count);
+    onward_aspush(len - count);
+}
+
+/** Shorten a string to exclude its trailing whitespace */
+defcode("-trailing", dash_trailing, &slash_string, 0u) {
+    value_t len     = onward_aspop();
+    char const* str = (char const*)onward_aspeek(0);
+    while ((len > 0) && str[len-1] && strchr(" \t\r\n", str[len-1]))
+        len--;
+    onward_aspush(len);
+}
+
+/** Split a string at the first occurrence of a character. The part before it
+ * is pushed on top of the part after it. If the character is not found the
+ * whole string is the first part and the rest is empty. */
+defcode("split", split, &dash_trailing, 0u) {
+    char delim      = (char)onward_aspop();
+    value_t len     = onward_aspop();
+    char const* str = (char const*)onward_aspop();
+    char const* end = (len > 0) ? (char const*)memchr(str, delim, (size_t)len) : NULL;
+    value_t head    = end ? (value_t)(end - str) : len;
+    value_t skip    = end ? head + 1 : head;
+    onward_aspush((value_t)(str + skip));
+    onward_aspush(len - skip);
+    onward_aspush((value_t)str);
+    onward_aspush(head);
+}
+
+/** Search the second string for the top string. If it is found the remainder
+ * of the second string starting at the match and 1 are pushed, otherwise the
+ * second string and 0. */
+defcode("search", search, &split, 0u) {
+    value_t sublen  = onward_aspop();
+    char const* sub = (char const*)onward_aspop();
+    value_t len     = onward_aspop();
+    char const* str = (char const*)onward_aspop();
+    char const* found = slice_find(str, len, sub, sublen);
+    if (found) {
+        onward_aspush((value_t)found);
+        onward_aspush(len - (value_t)(found - str));
+    } else {
+        onward_aspush((value_t)str);
+        onward_aspush(len);
+    }
+    onward_aspush(found != NULL);
+}
+
+/** Compare two strings, pushing -1 if the second string orders before the top
+ * string, 1 if it orders after, and 0 if they are equal */
+defcode("compare", compare, &search, 0u) {
+    value_t rlen    = onward_aspop();
+    char const* rhs = (char const*)onward_aspop();
+    value_t llen    = onward_aspop();
+    char const* lhs = (char const*)onward_aspop();
+    value_t len     = (llen < rlen) ? llen : rlen;
+    int result      = (len > 0) ? memcmp(lhs, rhs, (size_t)len) : 0;
+    if (!result)
+        result = (llen > rlen) - (llen < rlen);
+    onward_aspush((result > 0) - (result < 0));
+}
+
+/** Parse a string as a number literal. Pushes the number and 1 on success,
+ * otherwise the string and 0. */
+defcode("snum", snum, &compare, 0u) {
+    value_t len     = onward_aspop();
+    char const* str = (char const*)onward_aspop();
+    value_t value;
+    if (onward_number(str, len, &value)) {
+        onward_aspush(value);
+        onward_aspush(1);
+    } else {
+        onward_aspush((value_t)str);
+        onward_aspush(len);
+        onward_aspush(0);
+    }
+}
+
+/** Print the characters of a string */
+defcode("type", slice_type, &snum, 0u) {
+    value_t len     = onward_aspop();
+    char const* str = (char const*)onward_aspop();
+    value_t i;
+    for (i = 0; i < len; i++) {
+        onward_aspush((unsigned char)str[i]);
+        emit_code();
+    }
+}
+
+/* Find the first occurrence of a string within another, scanning for its first
+ * character before comparing the rest */
+static char const* slice_find(char const* str, value_t len, char const* sub, value_t sublen) {
+    char const* end;
+    if (sublen > len)
+        return NULL;
+    else if (sublen <= 0)
+        return str;
+    end = str + len - sublen;
+    while ((str <= end) && (str = (char const*)memchr(str, sub[0], (size_t)(end - str + 1)))) {
+        if (!memcmp(str + 1, sub + 1, (size_t)(sublen - 1)))
+            return str;
+        str++;
+    }
+    return NULL;
+}
@@ -0,0 +1,217 @@
+#include "onward.h"
+#include <string.h>
+
+/* The bit set in the hash of every occupied entry so empty entries are 0 */
+#define TABLE_USED ((uvalue_t)1u << (CELL_BITS - 1u))
+
+/* The most entries a table may have so that its size in bytes fits in a cell */
+#define TABLE_MAX_ENTRIES (((uvalue_t)1u << (CELL_BITS - 2u)) / sizeof(table_entry_t))
+
+typedef struct {
+    /* The hash of the key with TABLE_USED set, or 0 if the entry is empty */
+    uvalue_t hash;
+    /* The key, or the address of the bytes of a string key */
+    value_t key;
+    /* The length of a string key */
+    value_t len;
+    value_t val;
+} table_entry_t;
+
+typedef struct {
+    /* The number of entries minus one, the number of entries is a power of 2 */
+    uvalue_t mask;
+    /* The number of keys in the table */
+    value_t count;
+    /* The maximum number of keys the table will hold */
+    value_t limit;
+    /* Whether the keys are byte strings rather than cells */
+    value_t strings;
+    table_entry_t entries[];
+} table_t;
+
+static uvalue_t table_capacity(value_t limit);
+static table_t* table_setup(void* addr, uvalue_t capacity, value_t limit, value_t strings);
+static table_entry_t* table_find(table_t* table, value_t key, value_t len, uvalue_t hash);
+static uvalue_t table_hash(table_t* table, value_t* key, value_t* len);
+
+/** Push the number of bytes needed by a table holding the given number of
+ * keys */
+defcode("table-bytes", table_bytes, &par_reduce, 0u) {
+    uvalue_t capacity = table_capacity(onward_aspop());
+    if (capacity)
+        onward_aspush(sizeof(table_t) + (capacity * sizeof(table_entry_t)));
+}
+
+/** Initialize a table at the given address holding the given number of keys.
+ * The keys are byte strings if the top item is non-zero, otherwise cells. */
+defcode("table-init", table_init, &table_bytes, 0u) {
+    value_t strings   = onward_aspop();
+    value_t limit     = onward_aspop();
+    void* addr        = (void*)onward_aspop();
+    uvalue_t capacity = table_capacity(limit);
+    if (capacity)
+        onward_aspush((value_t)table_setup(addr, capacity, limit, strings));
+}
+
+/** Allocate a table with cell keys holding the given number of keys from the
+ * dictionary */
+defcode("table", table, &table_init, 0u) {
+    value_t limit     = onward_aspop();
+    uvalue_t capacity = table_capacity(limit);
+    value_t pad       = (value_t)((sizeof(value_t) - ((uvalue_t)here % sizeof(value_t))) % sizeof(value_t));
+    value_t addr      = 0;
+    if (capacity)
+        addr = onward_allot(pad + (value_t)(sizeof(table_t) + (capacity * sizeof(table_entry_t))));
+    if (addr)
+        onward_aspush((value_t)table_setup((void*)(addr + pad), capacity, limit, 0));
+}
+
+/** Allocate a table with byte string keys holding the given number of keys
+ * from the dictionary. Only the address and length of each key are stored so
+ * the bytes must not change while the key is in the table. */
+defcode("strtable", strtable, &table, 0u) {
+    table_code();
+    ((table_t*)onward_aspeek(0))->strings = 1;
+}
+
+/** Set the value for a key in a table. A string key is given as an address
+ * and a length. */
+defcode("table!", table_store, &strtable, 0u) {
+    table_t* table = (table_t*)onward_aspop();
+    value_t key, len;
+    uvalue_t hash = table_hash(table, &key, &len);
+    value_t val   = onward_aspop();
+    table_entry_t* entry = table_find(table, key, len, hash);
+    if (!entry->hash) {
+        if (table->count >= table->limit) {
+            onward_throw(ERR_TABLE_FULL);
+            return;
+        }
+        table->count++;
+        entry->hash = hash;
+        entry->key  = key;
+        entry->len  = len;
+    }
+    entry->val = val;
+}
+
+/** Lookup a key in a table, pushing the value and 1 if found, otherwise 0 and
+ * 0 */
+defcode("table@", table_fetch, &table_store, 0u) {
+    table_t* table = (table_t*)onward_aspop();
+    value_t key, len;
+    uvalue_t hash = table_hash(table, &key, &len);
+    table_entry_t* entry = table_find(table, key, len, hash);
+    onward_aspush(entry->hash ? entry->val : 0);
+    onward_aspush(entry->hash != 0);
+}
+
+/** Remove a key from a table, pushing 1 if the key was found otherwise 0 */
+defcode("table-del", table_delete, &table_fetch, 0u) {
+    table_t* table = (table_t*)onward_aspop();
+    value_t key, len;
+    uvalue_t hash = table_hash(table, &key, &len);
+    table_entry_t* entry = table_find(table, key, len, hash);
+    uvalue_t i = (uvalue_t)(entry - table->entries);
+    uvalue_t j = i;
+    onward_aspush(entry->hash != 0);
+    if (entry->hash) {
+        table->count--;
+        /* Shift back the following entries of the probe sequence that would
+         * no longer be reachable through the emptied entry */
+        for (j = (j + 1u) & table->mask; table->entries[j].hash; j = (j + 1u) & table->mask) {
+            uvalue_t home = table->entries[j].hash & table->mask;
+            if (((j - home) & table->mask) >= ((j - i) & table->mask)) {
+                table->entries[i] = table->entries[j];
+                i = j;
+            }
+        }
+        table->entries[i].hash = 0;
+    }
+}
+
+/** Push the number of keys in a table */
+defcode("table-count", table_count, &table_delete, 0u) {
+    onward_aspush(((table_t*)onward_aspop())->count);
+}
+
+/** Execute a word for each key in a table with the key and the value on the
+ * stack. The word must not add or remove keys. */
+defcode("table-each", table_each, &table_count, 0u) {
+    word_t const* word = (word_t const*)onward_aspop();
+    table_t* table     = (table_t*)onward_aspop();
+    uvalue_t i;
+    for (i = 0; i <= table->mask; i++) {
+        table_entry_t* entry = &(table->entries[i]);
+        if (entry->hash) {
+            onward_aspush(entry->key);
+            if (table->strings)
+                onward_aspush(entry->len);
+            onward_aspush(entry->val);
+            onward_exec(word);
+        }
+    }
+}
+
+/* Helper C Functions
+ *****************************************************************************/
+/* Tables are kept at most half full so probe sequences stay short. Throws and
+ * returns 0 if the number of keys is not positive or the table would not fit
+ * in memory. */
+static uvalue_t table_capacity(value_t limit) {
+    uvalue_t capacity = 1u;
+    if ((limit <= 0) || ((uvalue_t)limit > (TABLE_MAX_ENTRIES / 2u))) {
+        onward_throw(ERR_BAD_SIZE);
+        return 0;
+    }
+    while (capacity < (2u * (uvalue_t)limit))
+        capacity <<= 1u;
+    return capacity;
+}
+
+static table_t* table_setup(void* addr, uvalue_t capacity, value_t limit, value_t strings) {
+    table_t* table  = (table_t*)addr;
+    table->mask    = capacity - 1u;
+    table->count   = 0;
+    table->limit   = limit;
+    table->strings = (strings != 0);
+    memset(table->entries, 0, capacity * sizeof(table_entry_t));
+    return table;
+}
+
+/* Find the entry holding the key or the empty entry where it belongs */
+static table_entry_t* table_find(table_t* table, value_t key, value_t len, uvalue_t hash) {
+    uvalue_t i = hash & table->mask;
+    for (;; i = (i + 1u) & table->mask) {
+        table_entry_t* entry = &(table->entries[i]);
+        if (!entry->hash)
+            return entry;
+        if ((entry->hash == hash) && (entry->key == key) && (entry->len == len))
+            return entry;
+        if ((entry->hash == hash) && table->strings && (entry->len == len) &&
+            !memcmp((void*)entry->key, (void*)key, (size_t)len))
+            return entry;
+    }
+}
+
+/* Pop the key for the table and compute its hash. Cells are mixed with a
+ * multiplicative hash and strings are hashed with FNV-1a. */
+static uvalue_t table_hash(table_t* table, value_t* key, value_t* len) {
+    uvalue_t hash;
+    if (table->strings) {
+        unsigned char const* bytes;
+        value_t i;
+        *len  = onward_aspop();
+        *key  = onward_aspop();
+        bytes = (unsigned char const*)*key;
+        hash  = (uvalue_t)UINT64_C(14695981039346656037);
+        for (i = 0; i < *len; i++)
+            hash = (hash ^ bytes[i]) * (uvalue_t)UINT64_C(1099511628211);
+    } else {
+        *len = 0;
+        *key = onward_aspop();
+        hash = (uvalue_t)*key * (uvalue_t)UINT64_C(0x9E3779B97F4A7C15);
+        hash ^= hash >> (CELL_BITS / 2u);
+    }
+    return hash | TABLE_USED;
+}
@@ -22,16 +22,43 @@ void state_reset(void) {
     asp = asb;
     rsp = rsb;
     errcode = 0;
+    handler = 0;
+    tokens = 0;
     state = 0;
     here = (value_t)Word_Buffer;
+    latest = (value_t)LATEST_BUILTIN;
+    onward_limit(0, 0, 0);
 }
 
 int main(int argc, char** argv)
 {
+    onward_init_t init = {
+        Argument_Stack, sizeof(Argument_Stack),
+        Return_Stack,   sizeof(Return_Stack),
+        Word_Buffer,    sizeof(Word_Buffer),
+        0u,
+        fetch_char,
+        emit_char
+    };
     (void)argc;
     (void)argv;
+    onward_init(&init);
     /* Run the tests and report the results */
     RUN_EXTERN_TEST_SUITE(Constants_And_Variables);
     RUN_EXTERN_TEST_SUITE(Interpreter);
+    RUN_EXTERN_TEST_SUITE(Embedding);
+    RUN_EXTERN_TEST_SUITE(Multitasking);
+    RUN_EXTERN_TEST_SUITE(Arithmetic);
+    RUN_EXTERN_TEST_SUITE(Error_Handling);
+    RUN_EXTERN_TEST_SUITE(Hash_Tables);
+    RUN_EXTERN_TEST_SUITE(Sorting);
+    RUN_EXTERN_TEST_SUITE(Token_Threading);
+    RUN_EXTERN_TEST_SUITE(Stack_And_Locals);
+    RUN_EXTERN_TEST_SUITE(String_Slices);
+    RUN_EXTERN_TEST_SUITE(Atomics);
+    RUN_EXTERN_TEST_SUITE(Channels);
+    RUN_EXTERN_TEST_SUITE(Files);
+    RUN_EXTERN_TEST_SUITE(Timing);
+    RUN_EXTERN_TEST_SUITE(Standalone);
     return PRINT_TEST_RESULTS();
 }
@@ -0,0 +1,178 @@
+// Unit Test Framework Includes
+#include "atf.h"
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+static void exec_prim(const word_t* word) {
+    ((primitive_t)word->code)();
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Arithmetic) {
+    //-------------------------------------------------------------------------
+    // Testing: um*
+    //-------------------------------------------------------------------------
+    TEST(Verify_umul_gives_the_full_unsigned_product)
+    {
+        state_reset();
+        onward_aspush(-1);
+        onward_aspush(-1);
+        exec_prim(&umul);
+        /* (2^n - 1)^2 = (2^n - 2) * 2^n + 1 */
+        CHECK(-2 == onward_aspop());
+        CHECK(1 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: m*
+    //-------------------------------------------------------------------------
+    TEST(Verify_mmul_gives_the_full_signed_product)
+    {
+        state_reset();
+        onward_aspush(-5);
+        onward_aspush(7);
+        exec_prim(&mmul);
+        CHECK(-1 == onward_aspop());
+        CHECK(-35 == onward_aspop());
+        onward_aspush((value_t)1 << (CELL_BITS - 2u));
+        onward_aspush(8);
+        exec_prim(&mmul);
+        CHECK(2 == onward_aspop());
+        CHECK(0 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: um/mod
+    //-------------------------------------------------------------------------
+    TEST(Verify_umdivmod_divides_a_double_cell_value)
+    {
+        state_reset();
+        onward_aspush(-1);
+        onward_aspush(-1);
+        exec_prim(&umul);
+        onward_aspush(-1);
+        exec_prim(&umdivmod);
+        CHECK(-1 == onward_aspop());
+        CHECK(0 == onward_aspop());
+        onward_aspush(5);
+        onward_aspush(1);
+        onward_aspush(4);
+        exec_prim(&umdivmod);
+        CHECK(((value_t)1 << (CELL_BITS - 2u)) + 1 == onward_aspop());
+        CHECK(1 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_umdivmod_throws_for_a_zero_divisor)
+    {
+        state_reset();
+        onward_aspush(5);
+        onward_aspush(0);
+        onward_aspush(0);
+        exec_prim(&umdivmod);
+        CHECK(ERR_BAD_DIVIDE == errcode);
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_umdivmod_throws_if_the_quotient_does_not_fit_a_cell)
+    {
+        state_reset();
+        onward_aspush(0);
+        onward_aspush(3);
+        onward_aspush(3);
+        exec_prim(&umdivmod);
+        CHECK(ERR_BAD_DIVIDE == errcode);
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: */mod
+    //-------------------------------------------------------------------------
+    TEST(Verify_muldivmod_truncates_toward_zero)
+    {
+        state_reset();
+        onward_aspush(-7);
+        onward_aspush(3);
+        onward_aspush(2);
+        exec_prim(&muldivmod);
+        CHECK(-10 == onward_aspop());
+        CHECK(-1 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_muldivmod_throws_for_a_zero_divisor)
+    {
+        state_reset();
+        onward_aspush(3);
+        onward_aspush(4);
+        onward_aspush(0);
+        exec_prim(&muldivmod);
+        CHECK(ERR_BAD_DIVIDE == errcode);
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: */
+    //-------------------------------------------------------------------------
+    TEST(Verify_muldiv_does_not_overflow_the_intermediate_product)
+    {
+        value_t big = (value_t)1 << (CELL_BITS - 2u);
+        state_reset();
+        onward_aspush(big);
+        onward_aspush(12);
+        onward_aspush(16);
+        exec_prim(&muldiv);
+        CHECK((big / 4) * 3 == onward_aspop());
+        onward_aspush(-big);
+        onward_aspush(big);
+        onward_aspush(big);
+        exec_prim(&muldiv);
+        CHECK(-big == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_muldiv_throws_for_a_zero_divisor)
+    {
+        state_reset();
+        onward_aspush(3);
+        onward_aspush(4);
+        onward_aspush(0);
+        exec_prim(&muldiv);
+        CHECK(ERR_BAD_DIVIDE == errcode);
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_muldiv_throws_if_the_quotient_does_not_fit_a_cell)
+    {
+        value_t big = (value_t)1 << (CELL_BITS - 2u);
+        value_t min = -2 * big;
+        state_reset();
+        onward_aspush(big);
+        onward_aspush(big);
+        onward_aspush(1);
+        exec_prim(&muldiv);
+        CHECK(ERR_BAD_DIVIDE == errcode);
+        CHECK(asb == asp);
+        /* The most negative cell fits but its negation does not */
+        state_reset();
+        onward_aspush(min);
+        onward_aspush(1);
+        onward_aspush(1);
+        exec_prim(&muldiv);
+        CHECK(ERR_NONE == errcode);
+        CHECK(min == onward_aspop());
+        onward_aspush(min);
+        onward_aspush(-1);
+        onward_aspush(1);
+        exec_prim(&muldiv);
+        CHECK(ERR_BAD_DIVIDE == errcode);
+        CHECK(asb == asp);
+    }
+}
@@ -0,0 +1,127 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <pthread.h>
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+#define ADD_THREADS 4
+#define ADD_COUNT   10000
+
+static value_t Counter = 0;
+
+static void exec_prim(const word_t* word) {
+    ((primitive_t)word->code)();
+}
+
+/* Add to the counter from a thread with its own interpreter registers */
+static void* add_thread(void* arg) {
+    value_t arg_stack[16], ret_stack[16];
+    onward_init_t init = {
+        arg_stack, sizeof(arg_stack),
+        ret_stack, sizeof(ret_stack),
+        NULL, 0, NULL, NULL, NULL
+    };
+    int i;
+    (void)arg;
+    onward_init(&init);
+    for (i = 0; i < ADD_COUNT; i++) {
+        onward_aspush((value_t)&Counter);
+        onward_aspush(1);
+        onward_aspush(MO_RELAXED);
+        exec_prim(&afetch_add);
+        (void)onward_aspop();
+    }
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Atomics) {
+    //-------------------------------------------------------------------------
+    // Testing: atomic@ atomic!
+    //-------------------------------------------------------------------------
+    TEST(Verify_atomic_store_and_fetch_access_the_cell)
+    {
+        value_t cell = 0;
+        state_reset();
+        onward_aspush((value_t)&cell);
+        onward_aspush(42);
+        onward_aspush(MO_RELEASE);
+        exec_prim(&astore);
+        CHECK(42 == cell);
+        onward_aspush((value_t)&cell);
+        onward_aspush(MO_ACQUIRE);
+        exec_prim(&afetch);
+        CHECK(42 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: atomic-add
+    //-------------------------------------------------------------------------
+    TEST(Verify_atomic_add_pushes_the_previous_value)
+    {
+        value_t cell = 5;
+        state_reset();
+        onward_aspush((value_t)&cell);
+        onward_aspush(-2);
+        onward_aspush(MO_SEQ_CST);
+        exec_prim(&afetch_add);
+        CHECK(5 == onward_aspop());
+        CHECK(3 == cell);
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_atomic_add_does_not_lose_updates_between_threads)
+    {
+        pthread_t threads[ADD_THREADS];
+        int i;
+        state_reset();
+        Counter = 0;
+        for (i = 0; i < ADD_THREADS; i++)
+            CHECK(0 == pthread_create(&threads[i], NULL, add_thread, NULL));
+        for (i = 0; i < ADD_THREADS; i++)
+            pthread_join(threads[i], NULL);
+        CHECK((ADD_THREADS * ADD_COUNT) == Counter);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: atomic-cas
+    //-------------------------------------------------------------------------
+    TEST(Verify_atomic_cas_swaps_only_if_the_cell_holds_the_expected_value)
+    {
+        value_t cell = 7;
+        state_reset();
+        onward_aspush((value_t)&cell);
+        onward_aspush(7);
+        onward_aspush(9);
+        onward_aspush(MO_ACQ_REL);
+        exec_prim(&acas);
+        CHECK(7 == onward_aspop());
+        CHECK(9 == cell);
+        onward_aspush((value_t)&cell);
+        onward_aspush(7);
+        onward_aspush(11);
+        onward_aspush(MO_RELEASE);
+        exec_prim(&acas);
+        CHECK(9 == onward_aspop());
+        CHECK(9 == cell);
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: fence
+    //-------------------------------------------------------------------------
+    TEST(Verify_fence_consumes_the_memory_order)
+    {
+        state_reset();
+        onward_aspush(MO_SEQ_CST);
+        exec_prim(&afence);
+        CHECK(ERR_NONE == errcode);
+        CHECK(asb == asp);
+    }
+}
@@ -0,0 +1,218 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <pthread.h>
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+#define MPMC_THREADS 4
+#define MPMC_COUNT   5000
+
+static value_t Chan_Buf[512];
+static value_t Received[MPMC_THREADS];
+
+static void exec_prim(const word_t* word) {
+    ((primitive_t)word->code)();
+}
+
+static value_t chan_new(value_t limit, value_t multi) {
+    onward_aspush((value_t)Chan_Buf);
+    onward_aspush(limit);
+    onward_aspush(multi);
+    exec_prim(&chan_init);
+    return onward_aspop();
+}
+
+static void thread_init(value_t* arg_stack, value_t* ret_stack) {
+    onward_init_t init = {
+        arg_stack, 16 * sizeof(value_t),
+        ret_stack, 16 * sizeof(value_t),
+        NULL, 0, NULL, NULL, NULL
+    };
+    onward_init(&init);
+}
+
+/* Send the numbers 1 to MPMC_COUNT with a thread of its own */
+static void* send_thread(void* arg) {
+    value_t arg_stack[16], ret_stack[16], i;
+    thread_init(arg_stack, ret_stack);
+    for (i = 1; i <= MPMC_COUNT; i++) {
+        onward_aspush(i);
+        onward_aspush(*((value_t*)arg));
+        exec_prim(&chan_send);
+    }
+    return NULL;
+}
+
+/* Receive MPMC_COUNT numbers with a thread of its own and sum them */
+static void* recv_thread(void* arg) {
+    value_t arg_stack[16], ret_stack[16], i, sum = 0;
+    thread_init(arg_stack, ret_stack);
+    for (i = 0; i < MPMC_COUNT; i++) {
+        onward_aspush(((value_t*)arg)[0]);
+        exec_prim(&chan_recv);
+        sum += onward_aspop();
+    }
+    Received[((value_t*)arg)[1]] = sum;
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Channels) {
+    //-------------------------------------------------------------------------
+    // Testing: chan-send chan-recv
+    //-------------------------------------------------------------------------
+    TEST(Verify_cells_are_received_in_the_order_they_were_sent)
+    {
+        value_t chan;
+        state_reset();
+        chan = chan_new(4, 0);
+        onward_aspush(7);
+        onward_aspush(chan);
+        exec_prim(&chan_send);
+        onward_aspush(8);
+        onward_aspush(chan);
+        exec_prim(&chan_send);
+        onward_aspush(chan);
+        exec_prim(&chan_recv);
+        CHECK(7 == onward_aspop());
+        onward_aspush(chan);
+        exec_prim(&chan_recv);
+        CHECK(8 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: channel sizes
+    //-------------------------------------------------------------------------
+    TEST(Verify_chan_rejects_sizes_that_are_not_positive_or_too_large)
+    {
+        value_t start;
+        state_reset();
+        start = here;
+        CHECK(ERR_BAD_SIZE == onward_eval("0 chan", 6));
+        CHECK(ERR_BAD_SIZE == onward_eval("-1 mpmc-chan", 12));
+        onward_aspush(~(value_t)0 ^ ((value_t)1 << (CELL_BITS - 1)));
+        CHECK(ERR_BAD_SIZE == onward_eval("chan-bytes", 10));
+        CHECK(start == here);
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_chan_throws_if_it_does_not_fit_in_the_dictionary)
+    {
+        value_t start;
+        state_reset();
+        start = here;
+        CHECK(ERR_DICT_FULL == onward_eval("100000 chan", 11));
+        CHECK(start == here);
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: chan-send? chan-recv?
+    //-------------------------------------------------------------------------
+    TEST(Verify_non_blocking_words_fail_when_full_or_empty)
+    {
+        value_t chan, i;
+        state_reset();
+        chan = chan_new(4, 1);
+        onward_aspush(chan);
+        exec_prim(&chan_try_recv);
+        CHECK(0 == onward_aspop());
+        CHECK(0 == onward_aspop());
+        for (i = 0; i < 4; i++) {
+            onward_aspush(i);
+            onward_aspush(chan);
+            exec_prim(&chan_try_send);
+            CHECK(1 == onward_aspop());
+        }
+        onward_aspush(4);
+        onward_aspush(chan);
+        exec_prim(&chan_try_send);
+        CHECK(0 == onward_aspop());
+        onward_aspush(chan);
+        exec_prim(&chan_try_recv);
+        CHECK(1 == onward_aspop());
+        CHECK(0 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: chan-send-n? chan-recv-n
+    //-------------------------------------------------------------------------
+    TEST(Verify_batches_move_as_many_cells_as_fit)
+    {
+        value_t data[6] = { 1, 2, 3, 4, 5, 6 };
+        value_t out[4]  = { 0, 0, 0, 0 };
+        value_t multi;
+        for (multi = 0; multi < 2; multi++) {
+            value_t chan;
+            state_reset();
+            chan = chan_new(4, multi);
+            onward_aspush((value_t)data);
+            onward_aspush(6);
+            onward_aspush(chan);
+            exec_prim(&chan_try_send_n);
+            CHECK(4 == onward_aspop());
+            onward_aspush((value_t)out);
+            onward_aspush(4);
+            onward_aspush(chan);
+            exec_prim(&chan_recv_n);
+            CHECK((1 == out[0]) && (2 == out[1]) && (3 == out[2]) && (4 == out[3]));
+            onward_aspush((value_t)out);
+            onward_aspush(4);
+            onward_aspush(chan);
+            exec_prim(&chan_try_recv_n);
+            CHECK(0 == onward_aspop());
+            CHECK(asb == asp);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: chan-send-slice chan-recv-slice
+    //-------------------------------------------------------------------------
+    TEST(Verify_slices_are_sent_as_one_message)
+    {
+        static char str[] = "hello";
+        value_t chan;
+        state_reset();
+        chan = chan_new(2, 1);
+        onward_aspush((value_t)str);
+        onward_aspush(5);
+        onward_aspush(chan);
+        exec_prim(&chan_send_slice);
+        onward_aspush(1);
+        onward_aspush(chan);
+        exec_prim(&chan_try_send);
+        CHECK(0 == onward_aspop());
+        onward_aspush(chan);
+        exec_prim(&chan_recv_slice);
+        CHECK(5 == onward_aspop());
+        CHECK((value_t)str == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_cells_are_not_lost_between_many_senders_and_receivers)
+    {
+        pthread_t senders[MPMC_THREADS], receivers[MPMC_THREADS];
+        value_t args[MPMC_THREADS][2], chan, i, total = 0;
+        state_reset();
+        chan = chan_new(64, 1);
+        for (i = 0; i < MPMC_THREADS; i++) {
+            args[i][0] = chan;
+            args[i][1] = i;
+            CHECK(0 == pthread_create(&receivers[i], NULL, recv_thread, args[i]));
+            CHECK(0 == pthread_create(&senders[i], NULL, send_thread, &chan));
+        }
+        for (i = 0; i < MPMC_THREADS; i++) {
+            pthread_join(senders[i], NULL);
+            pthread_join(receivers[i], NULL);
+            total += Received[i];
+        }
+        CHECK((MPMC_THREADS * (MPMC_COUNT * (MPMC_COUNT + 1) / 2)) == total);
+    }
+}
@@ -0,0 +1,264 @@
+// Unit Test Framework Includes
+#include "atf.h"
+
+// File To Test
+#include "onward.h"
+#include <string.h>
+
+void state_reset(void);
+
+static value_t Throw_Code[] = { W(lit), 1, W(lit), 42, W(_throw), W(lit), 2, 0u };
+static const word_t Throw_Word = { 0u, 0u, "throw-word", Throw_Code };
+
+static value_t Nested_Code[] = { W(lit), (value_t)&Throw_Word, W(_catch), W(lit), 3, W(_throw), 0u };
+static const word_t Nested_Word = { 0u, 0u, "nested-word", Nested_Code };
+
+static value_t Recurse_Code[2];
+static const word_t Recurse_Word = { 0u, 0u, "recurse-word", Recurse_Code };
+
+static value_t Spin_Code[] = { W(br), -(value_t)sizeof(value_t), 0u };
+static const word_t Spin_Word = { 0u, 0u, "spin-word", Spin_Code };
+
+static void exec_prim(const word_t* word) {
+    ((primitive_t)word->code)();
+}
+
+static value_t eval(char const* source) {
+    return onward_eval(source, (value_t)strlen(source));
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Error_Handling) {
+    //-------------------------------------------------------------------------
+    // Testing: catch
+    //-------------------------------------------------------------------------
+    TEST(Verify_catch_pushes_zero_when_the_word_completes)
+    {
+        state_reset();
+        onward_aspush(3);
+        onward_aspush((value_t)&_dup);
+        exec_prim(&_catch);
+        CHECK(0 == onward_aspop());
+        CHECK(3 == onward_aspop());
+        CHECK(3 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+        CHECK(0 == handler);
+    }
+
+    TEST(Verify_catch_restores_the_stacks_and_pushes_the_thrown_code)
+    {
+        state_reset();
+        onward_aspush(7);
+        onward_aspush((value_t)&Throw_Word);
+        exec_prim(&_catch);
+        CHECK(42 == onward_aspop());
+        CHECK(7 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+        CHECK(0 == handler);
+        CHECK(ERR_NONE == errcode);
+    }
+
+    TEST(Verify_catch_frames_nest)
+    {
+        state_reset();
+        onward_aspush((value_t)&Nested_Word);
+        exec_prim(&_catch);
+        CHECK(3 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(0 == handler);
+    }
+
+    TEST(Verify_catch_handles_argument_stack_underflow)
+    {
+        state_reset();
+        onward_aspush((value_t)&drop);
+        exec_prim(&_catch);
+        CHECK(ERR_ARG_STACK_UNDRFLW == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_catch_handles_return_stack_overflow)
+    {
+        state_reset();
+        Recurse_Code[0] = (value_t)&Recurse_Word;
+        onward_aspush((value_t)&Recurse_Word);
+        exec_prim(&_catch);
+        CHECK(ERR_RET_STACK_OVRFLW == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: throw
+    //-------------------------------------------------------------------------
+    TEST(Verify_throw_of_zero_does_nothing)
+    {
+        state_reset();
+        onward_aspush(0);
+        exec_prim(&_throw);
+        CHECK(ERR_NONE == errcode);
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_uncaught_throw_sets_errcode_and_unwinds_to_the_host)
+    {
+        state_reset();
+        onward_exec(&Throw_Word);
+        CHECK(42 == errcode);
+        CHECK(1 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+        /* Later words execute normally */
+        errcode = 0;
+        onward_aspush(5);
+        onward_exec(&_dup);
+        CHECK(5 == onward_aspop());
+        CHECK(5 == onward_aspop());
+    }
+
+    TEST(Verify_pop_from_an_empty_stack_sets_errcode)
+    {
+        state_reset();
+        CHECK(0 == onward_aspop());
+        CHECK(ERR_ARG_STACK_UNDRFLW == errcode);
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: primitives on an empty stack
+    //-------------------------------------------------------------------------
+    TEST(Verify_fetch_on_an_empty_stack_stops_with_an_error)
+    {
+        state_reset();
+        CHECK(ERR_ARG_STACK_UNDRFLW == eval("@ 1"));
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_exec_on_an_empty_stack_stops_with_an_error)
+    {
+        state_reset();
+        CHECK(ERR_ARG_STACK_UNDRFLW == eval("exec 1"));
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_find_on_an_empty_stack_stops_with_an_error)
+    {
+        state_reset();
+        CHECK(ERR_ARG_STACK_UNDRFLW == eval("find 1"));
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_fetch_on_an_empty_stack_is_caught)
+    {
+        state_reset();
+        CHECK(ERR_NONE == eval("' @ catch"));
+        CHECK(ERR_ARG_STACK_UNDRFLW == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+        CHECK(0 == handler);
+    }
+
+    TEST(Verify_exec_on_an_empty_stack_is_caught)
+    {
+        state_reset();
+        CHECK(ERR_NONE == eval("' exec catch"));
+        CHECK(ERR_ARG_STACK_UNDRFLW == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+        CHECK(0 == handler);
+    }
+
+    TEST(Verify_find_on_an_empty_stack_is_caught)
+    {
+        state_reset();
+        CHECK(ERR_NONE == eval("' find catch"));
+        CHECK(ERR_ARG_STACK_UNDRFLW == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+        CHECK(0 == handler);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: onward_limit
+    //-------------------------------------------------------------------------
+    TEST(Verify_fuel_stops_a_loop_once_it_is_used_up)
+    {
+        state_reset();
+        onward_limit(100, 0, 0);
+        onward_exec(&Spin_Word);
+        CHECK(ERR_OUT_OF_FUEL == errcode);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_fuel_stays_used_up_after_it_is_caught)
+    {
+        state_reset();
+        onward_limit(10, 0, 0);
+        onward_aspush((value_t)&Spin_Word);
+        exec_prim(&_catch);
+        CHECK(ERR_OUT_OF_FUEL == onward_aspop());
+        CHECK(ERR_NONE == errcode);
+        onward_exec(&Throw_Word);
+        CHECK(ERR_OUT_OF_FUEL == errcode);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_deadline_stops_a_loop_once_it_has_passed)
+    {
+        state_reset();
+        onward_limit(0, 1, 0);
+        onward_exec(&Spin_Word);
+        CHECK(ERR_DEADLINE == errcode);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_quota_stops_compiling_past_the_limit)
+    {
+        value_t start;
+        state_reset();
+        start = here;
+        onward_limit(0, 0, sizeof(value_t));
+        onward_aspush(42);
+        exec_prim(&comma);
+        CHECK(ERR_DICT_FULL == errcode);
+        CHECK(start == here);
+    }
+
+    TEST(Verify_a_script_cannot_lift_its_own_limits)
+    {
+        value_t base = hbase, size = hsize;
+        state_reset();
+        CHECK(ERR_UNKNOWN_WORD == eval("fuel"));
+        CHECK(ERR_UNKNOWN_WORD == eval("deadline"));
+        CHECK(ERR_UNKNOWN_WORD == eval("hlimit"));
+        onward_limit(1000, 0, 64);
+        CHECK(ERR_DICT_FULL == eval("4096 allot"));
+        CHECK(ERR_DICT_FULL == eval("here here @ 4096 - ! 8 allot"));
+        state_reset();
+        onward_limit(1000, 0, 64);
+        CHECK(ERR_DICT_FULL == eval("hsize hsize @ 2 * ! 4096 allot"));
+        hsize = size;
+        state_reset();
+        onward_limit(1000, 0, 64);
+        CHECK(ERR_DICT_FULL == eval("hbase here @ 32 + ! 128 allot"));
+        hbase = base;
+        state_reset();
+        onward_limit(1000, 0, 0);
+        CHECK(ERR_OUT_OF_FUEL == eval(": spin br [ 0 CELLSZ - , ] ; spin"));
+    }
+    TEST(Verify_allot_rejects_a_negative_size)
+    {
+        value_t start;
+        state_reset();
+        start = here;
+        CHECK(ERR_DICT_FULL == eval("-8 allot"));
+        CHECK(start == here);
+    }
+}
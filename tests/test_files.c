@@ -0,0 +1,277 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+deccode(included);
+deccode(required);
+deccode(include);
+deccode(require);
+deccode(each_line);
+deccode(perf);
+
+/* Longer than the names read by word so a truncated path would not open */
+#define LONG_PATH "/tmp/onward-test-files-with-a-name-longer-than-a-word.ft"
+#define MISSING_PATH "/tmp/onward-test-files-that-does-not-exist.ft"
+#define LINES_PATH "/tmp/onward-test-files-lines.txt"
+
+/* The size of the blocks read by each-line */
+#define BLOCK_SZ (64 * 1024)
+
+/* The length of each line passed to Record_Word and whether its characters
+ * all matched the first one */
+static value_t Line_Count;
+static value_t Line_Lengths[8];
+static value_t Line_Uniform[8];
+
+static void record_line(void) {
+    value_t len = onward_aspop();
+    char* line  = (char*)onward_aspop();
+    value_t i, same = 1;
+    for (i = 1; i < len; i++)
+        same = (same && (line[i] == line[0]));
+    if (Line_Count < 8) {
+        Line_Lengths[Line_Count] = len;
+        Line_Uniform[Line_Count] = same;
+    }
+    Line_Count++;
+}
+
+static const word_t Record_Word = { 0u, F_PRIMITIVE_MSK, "record-line", (value_t*)&record_line };
+
+static void exec_prim(const word_t* word) {
+    ((primitive_t)word->code)();
+}
+
+/* Reset the interpreter with the words of the standalone interpreter */
+static void files_reset(void) {
+    state_reset();
+    latest = (value_t)&perf;
+}
+
+static void write_file(char const* path, char const* text) {
+    FILE* file = fopen(path, "w");
+    fputs(text, file);
+    fclose(file);
+}
+
+/* Move the modification time of a file so it reads as changed. utime is
+ * not used as the interpreter defines a word of that name. */
+static void touch_file(char const* path, time_t mtime) {
+    struct timeval times[2] = { { mtime, 0 }, { mtime, 0 } };
+    utimes(path, times);
+}
+
+static value_t eval(char const* source) {
+    return onward_eval(source, (value_t)strlen(source));
+}
+
+/* Append a run of the same character, ending with a newline if asked */
+static void write_run(FILE* file, char ch, value_t count, int newline) {
+    while (count-- > 0)
+        fputc(ch, file);
+    if (newline)
+        fputc('\n', file);
+}
+
+/* Run each-line over a file with Record_Word, returning the error thrown */
+static value_t each_line_run(char const* path) {
+    FILE* file = fopen(path, "r");
+    value_t err;
+    Line_Count = 0;
+    onward_aspush((value_t)file);
+    onward_aspush((value_t)&Record_Word);
+    err = eval("each-line");
+    fclose(file);
+    return err;
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Files) {
+    //-------------------------------------------------------------------------
+    // Testing: included required
+    //-------------------------------------------------------------------------
+    TEST(Verify_included_interprets_the_named_file)
+    {
+        files_reset();
+        write_file(LONG_PATH, "1 2 +\n");
+        onward_aspush((value_t)LONG_PATH);
+        exec_prim(&included);
+        CHECK(0 == errcode);
+        CHECK(3 == onward_aspop());
+        CHECK(asb == asp);
+        remove(LONG_PATH);
+    }
+
+    TEST(Verify_included_throws_if_the_file_does_not_exist)
+    {
+        files_reset();
+        onward_aspush((value_t)MISSING_PATH);
+        CHECK(ERR_FILE_NOT_FOUND == eval("included 1"));
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_required_skips_a_file_that_is_unchanged)
+    {
+        files_reset();
+        write_file(LONG_PATH, "5\n");
+        touch_file(LONG_PATH, 1000);
+        onward_aspush((value_t)LONG_PATH);
+        exec_prim(&required);
+        onward_aspush((value_t)LONG_PATH);
+        exec_prim(&required);
+        CHECK(0 == errcode);
+        CHECK(5 == onward_aspop());
+        CHECK(asb == asp);
+        remove(LONG_PATH);
+    }
+
+    TEST(Verify_required_loads_a_file_again_once_it_is_modified)
+    {
+        files_reset();
+        write_file(LONG_PATH, "6\n");
+        touch_file(LONG_PATH, 2000);
+        onward_aspush((value_t)LONG_PATH);
+        exec_prim(&required);
+        touch_file(LONG_PATH, 3000);
+        onward_aspush((value_t)LONG_PATH);
+        exec_prim(&required);
+        CHECK(0 == errcode);
+        CHECK(6 == onward_aspop());
+        CHECK(6 == onward_aspop());
+        CHECK(asb == asp);
+        remove(LONG_PATH);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: include require
+    //-------------------------------------------------------------------------
+    TEST(Verify_include_reads_a_path_longer_than_a_word)
+    {
+        files_reset();
+        write_file(LONG_PATH, "7\n");
+        CHECK(0 == eval("include " LONG_PATH " 8"));
+        CHECK(8 == onward_aspop());
+        CHECK(7 == onward_aspop());
+        CHECK(asb == asp);
+        remove(LONG_PATH);
+    }
+
+    TEST(Verify_include_throws_if_the_file_does_not_exist)
+    {
+        files_reset();
+        CHECK(ERR_FILE_NOT_FOUND == eval("include " MISSING_PATH " 8"));
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_include_throws_if_the_path_does_not_fit_a_path_buffer)
+    {
+        static char source[8192];
+        files_reset();
+        strcpy(source, "include /tmp/");
+        memset(source + strlen(source), 'a', sizeof(source) - strlen(source) - 1u);
+        CHECK(ERR_FILE_NOT_FOUND == eval(source));
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_require_reads_a_path_longer_than_a_word)
+    {
+        files_reset();
+        write_file(LONG_PATH, "9\n");
+        touch_file(LONG_PATH, 4000);
+        CHECK(0 == eval("require " LONG_PATH " require " LONG_PATH));
+        CHECK(9 == onward_aspop());
+        CHECK(asb == asp);
+        remove(LONG_PATH);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: each-line
+    //-------------------------------------------------------------------------
+    TEST(Verify_each_line_passes_a_line_split_across_blocks_whole)
+    {
+        FILE* file = fopen(LINES_PATH, "w");
+        files_reset();
+        write_run(file, 'a', BLOCK_SZ - 10, 1);
+        write_run(file, 'b', 20, 1);
+        write_run(file, 'c', 3, 1);
+        fclose(file);
+        CHECK(0 == each_line_run(LINES_PATH));
+        CHECK(0 == onward_aspop());
+        CHECK(3 == Line_Count);
+        CHECK((BLOCK_SZ - 10) == Line_Lengths[0]);
+        CHECK(20 == Line_Lengths[1]);
+        CHECK(1 == Line_Uniform[1]);
+        CHECK(3 == Line_Lengths[2]);
+        CHECK(asb == asp);
+        remove(LINES_PATH);
+    }
+
+    TEST(Verify_each_line_grows_its_buffer_for_a_line_longer_than_a_block)
+    {
+        FILE* file = fopen(LINES_PATH, "w");
+        files_reset();
+        write_run(file, 'a', 3 * BLOCK_SZ + 5, 1);
+        write_run(file, 'b', 1, 1);
+        fclose(file);
+        CHECK(0 == each_line_run(LINES_PATH));
+        CHECK(0 == onward_aspop());
+        CHECK(2 == Line_Count);
+        CHECK((3 * BLOCK_SZ + 5) == Line_Lengths[0]);
+        CHECK(1 == Line_Uniform[0]);
+        CHECK(1 == Line_Lengths[1]);
+        CHECK(asb == asp);
+        remove(LINES_PATH);
+    }
+
+    TEST(Verify_each_line_passes_a_last_line_without_a_newline)
+    {
+        FILE* file = fopen(LINES_PATH, "w");
+        files_reset();
+        write_run(file, 'a', 4, 1);
+        write_run(file, 'b', 6, 0);
+        fclose(file);
+        CHECK(0 == each_line_run(LINES_PATH));
+        CHECK(0 == onward_aspop());
+        CHECK(2 == Line_Count);
+        CHECK(4 == Line_Lengths[0]);
+        CHECK(6 == Line_Lengths[1]);
+        CHECK(1 == Line_Uniform[1]);
+        CHECK(asb == asp);
+        remove(LINES_PATH);
+    }
+
+    TEST(Verify_each_line_passes_empty_lines)
+    {
+        FILE* file = fopen(LINES_PATH, "w");
+        files_reset();
+        write_run(file, 'a', 0, 1);
+        write_run(file, 'b', 2, 1);
+        fclose(file);
+        CHECK(0 == each_line_run(LINES_PATH));
+        CHECK(0 == onward_aspop());
+        CHECK(2 == Line_Count);
+        CHECK(0 == Line_Lengths[0]);
+        CHECK(2 == Line_Lengths[1]);
+        CHECK(asb == asp);
+        remove(LINES_PATH);
+    }
+
+    TEST(Verify_each_line_fails_without_a_file)
+    {
+        files_reset();
+        onward_aspush(0);
+        onward_aspush((value_t)&Record_Word);
+        CHECK(0 == eval("each-line"));
+        CHECK(1 == onward_aspop());
+        CHECK(asb == asp);
+    }
+}
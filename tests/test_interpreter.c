@@ -9,6 +9,25 @@ extern char* input;
 
 void state_reset(void);
 
+typedef struct {
+    value_t count;
+    value_t next;
+    value_t used;
+    onward_scan_t words[8];
+} scan_list_t;
+
+static value_t scan_list_next(char const* start, onward_scan_t* scan, void* ctx) {
+    scan_list_t* list = (scan_list_t*)ctx;
+    while ((list->next < list->count) && (list->words[list->next].start < start))
+        list->next++;
+    if ((list->next < list->count) && (list->words[list->next].start == start)) {
+        *scan = list->words[list->next++];
+        list->used++;
+        return 1;
+    }
+    return 0;
+}
+
 //-----------------------------------------------------------------------------
 // Begin Unit Tests
 //-----------------------------------------------------------------------------
@@ -241,6 +260,18 @@ TEST_SUITE(Interpreter) {
         CHECK((intptr_t)NULL == onward_aspop());
     }
 
+    TEST(Verify_find_counts_searches_and_the_words_visited)
+    {
+        state_reset();
+        stat_finds      = 0;
+        stat_find_steps = 0;
+        onward_aspush((intptr_t)((word_t*)latest)->link->name);
+        ((primitive_t)find.code)();
+        CHECK((intptr_t)((word_t*)latest)->link == onward_aspop());
+        CHECK(1 == stat_finds);
+        CHECK(2 == stat_find_steps);
+    }
+
     //-------------------------------------------------------------------------
     // Testing: exec
     //-------------------------------------------------------------------------
@@ -255,6 +286,57 @@ TEST_SUITE(Interpreter) {
         CHECK(asb == asp);
     }
 
+    TEST(Verify_exec_records_dispatched_words_in_the_trace_buffer)
+    {
+        state_reset();
+        trace_t buffer[4];
+        onward_trace_init(buffer, 6);
+        CHECK(4 == trsz);
+        onward_aspush(1);
+        onward_aspush(2);
+        onward_aspush((intptr_t)&add);
+        ((primitive_t)exec.code)();
+        onward_trace_init(0u, 0);
+        CHECK(3 == onward_aspop());
+        CHECK(0u == trbuf);
+        CHECK(&add == buffer[0].word);
+        CHECK(2 == buffer[0].tos);
+        CHECK(NULL == buffer[1].word);
+    }
+
+    TEST(Verify_exec_counts_dispatches_and_stack_high_water_marks)
+    {
+        static value_t code[] = { W(lit), 1, W(lit), 2, W(add), 0u };
+        static const word_t word = { 0u, 0u, "add-word", code };
+        state_reset();
+        stat_dispatches  = 0;
+        stat_prim_calls  = 0;
+        stat_colon_calls = 0;
+        stat_as_max      = 0;
+        stat_rs_max      = 0;
+        onward_exec(&word);
+        CHECK(3 == onward_aspop());
+        CHECK(6 == stat_dispatches);
+        CHECK(3 == stat_prim_calls);
+        CHECK(1 == stat_colon_calls);
+        CHECK(2 == stat_as_max);
+        CHECK(2 == stat_rs_max);
+    }
+
+    TEST(Verify_the_dictionary_high_water_mark_outlasts_a_rollback)
+    {
+        value_t start;
+        state_reset();
+        start         = here - hbase;
+        stat_dict_max = 0;
+        CHECK(0 != onward_allot(64));
+        here -= 64;
+        onward_aspush((value_t)"foo");
+        create_code();
+        CHECK((start + 64) == stat_dict_max);
+        CHECK((here - hbase) < stat_dict_max);
+    }
+
     //-------------------------------------------------------------------------
     // Testing: create
     //-------------------------------------------------------------------------
@@ -271,6 +353,59 @@ TEST_SUITE(Interpreter) {
         CHECK(0 == *(intptr_t*)here);
     }
 
+    //-------------------------------------------------------------------------
+    // Testing: marker
+    //-------------------------------------------------------------------------
+    TEST(Verify_marker_discards_the_words_defined_after_it)
+    {
+        onward_xt_t xt;
+        state_reset();
+        value_t old_here   = here;
+        value_t old_latest = latest;
+        input = " scratch ";
+        ((primitive_t)marker.code)();
+        word_t* mark = (word_t*)latest;
+        CHECK(0 == strcmp(mark->name, "scratch"));
+        CHECK(0 == (mark->flags & F_HIDDEN_MSK));
+        onward_aspush((intptr_t)"foo");
+        ((primitive_t)create.code)();
+        onward_xt_init(&xt, "foo");
+        CHECK((word_t*)latest == onward_xt_resolve(&xt));
+        onward_exec(mark);
+        CHECK(old_here == here);
+        CHECK(old_latest == latest);
+        CHECK(NULL == onward_xt_resolve(&xt));
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: forget
+    //-------------------------------------------------------------------------
+    TEST(Verify_forget_discards_the_named_word_and_those_after_it)
+    {
+        state_reset();
+        value_t old_here   = here;
+        value_t old_latest = latest;
+        onward_aspush((intptr_t)"foo");
+        ((primitive_t)create.code)();
+        onward_aspush((intptr_t)"bar");
+        ((primitive_t)create.code)();
+        input = " foo ";
+        ((primitive_t)forget.code)();
+        CHECK(old_here == here);
+        CHECK(old_latest == latest);
+    }
+
+    TEST(Verify_forget_refuses_built_in_words)
+    {
+        state_reset();
+        value_t old_latest = latest;
+        input = " dup ";
+        ((primitive_t)forget.code)();
+        CHECK(ERR_UNKNOWN_WORD == errcode);
+        CHECK(old_latest == latest);
+    }
+
     //-------------------------------------------------------------------------
     // Testing: ,
     //-------------------------------------------------------------------------
@@ -378,6 +513,44 @@ TEST_SUITE(Interpreter) {
     }
 #endif
 
+    //-------------------------------------------------------------------------
+    // Testing: onward_scan
+    //-------------------------------------------------------------------------
+    TEST(Verify_onward_scan_splits_and_classifies_words)
+    {
+        char const source[] = "  dup\t-0x1F\n";
+        onward_scan_t scan;
+        char const* next = onward_scan(source, source + strlen(source), &scan);
+        CHECK(scan.start == source + 2);
+        CHECK(next == source + 5);
+        CHECK(0 == scan.number);
+        CHECK(0 == strcmp(scan.name, "dup"));
+        next = onward_scan(next, source + strlen(source), &scan);
+        CHECK(1 == scan.number);
+        CHECK(-31 == scan.value);
+        CHECK(NULL == onward_scan(next, source + strlen(source), &scan));
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: onward_eval_scanned
+    //-------------------------------------------------------------------------
+    TEST(Verify_onward_eval_scanned_uses_scanned_words_and_skips_stale_ones)
+    {
+        char const source[] = "1 \\ 2 3\n4 dup + ";
+        scan_list_t list = {0};
+        char const* next = source;
+        state_reset();
+        while ((list.count < 8) && (next = onward_scan(next, source + strlen(source), &list.words[list.count])))
+            list.count++;
+        CHECK(source + strlen(source) == onward_eval_scanned(source, (value_t)strlen(source), scan_list_next, &list));
+        CHECK(8 == onward_aspop());
+        CHECK(1 == onward_aspop());
+        CHECK(asb == asp);
+        /* The words of the comment were discarded rather than interpreted */
+        CHECK(7 == list.count);
+        CHECK(5 == list.used);
+    }
+
     //-------------------------------------------------------------------------
     // Testing: interp
     //-------------------------------------------------------------------------
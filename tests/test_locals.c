@@ -0,0 +1,161 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <string.h>
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+static value_t eval(char const* source) {
+    return onward_eval(source, (value_t)strlen(source));
+}
+
+static void exec_prim(const word_t* word) {
+    ((primitive_t)word->code)();
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Stack_And_Locals) {
+    //-------------------------------------------------------------------------
+    // Testing: pick
+    //-------------------------------------------------------------------------
+    TEST(Verify_pick_copies_the_item_at_the_given_depth)
+    {
+        state_reset();
+        onward_aspush(7);
+        onward_aspush(8);
+        onward_aspush(9);
+        onward_aspush(2);
+        exec_prim(&pick);
+        CHECK(7 == onward_aspop());
+        CHECK(9 == onward_aspop());
+        CHECK(8 == onward_aspop());
+        CHECK(7 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_pick_throws_if_the_stack_is_not_deep_enough)
+    {
+        state_reset();
+        onward_aspush(7);
+        onward_aspush(1);
+        exec_prim(&pick);
+        CHECK(ERR_ARG_STACK_UNDRFLW == errcode);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: roll
+    //-------------------------------------------------------------------------
+    TEST(Verify_roll_moves_the_item_at_the_given_depth_to_the_top)
+    {
+        state_reset();
+        onward_aspush(10);
+        onward_aspush(20);
+        onward_aspush(30);
+        onward_aspush(40);
+        onward_aspush(3);
+        exec_prim(&roll);
+        CHECK(10 == onward_aspop());
+        CHECK(40 == onward_aspop());
+        CHECK(30 == onward_aspop());
+        CHECK(20 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: 2dup, 2swap, 2drop
+    //-------------------------------------------------------------------------
+    TEST(Verify_double_stack_words_operate_on_pairs)
+    {
+        state_reset();
+        onward_aspush(1);
+        onward_aspush(2);
+        onward_aspush(3);
+        onward_aspush(4);
+        exec_prim(&two_swap);
+        exec_prim(&two_dup);
+        CHECK(2 == onward_aspop());
+        CHECK(1 == onward_aspop());
+        exec_prim(&two_drop);
+        CHECK(4 == onward_aspop());
+        CHECK(3 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_swap_leaves_the_stack_unchanged_on_underflow)
+    {
+        state_reset();
+        onward_aspush(5);
+        exec_prim(&swap);
+        CHECK(ERR_ARG_STACK_UNDRFLW == errcode);
+        CHECK(5 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: {
+    //-------------------------------------------------------------------------
+    TEST(Verify_locals_are_initialized_from_the_stack_in_order)
+    {
+        state_reset();
+        CHECK(ERR_NONE == eval(": diff { a b -- c } a b - ; 10 3 diff "));
+        CHECK(7 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_locals_hide_words_with_the_same_name)
+    {
+        state_reset();
+        CHECK(ERR_NONE == eval(": sq { dup } dup dup * ; 6 sq "));
+        CHECK(36 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_locals_frames_are_separate_for_nested_calls)
+    {
+        state_reset();
+        CHECK(ERR_NONE == eval(": inner { x y } y x - ; : outer { x } x 1 inner x * ; 5 outer "));
+        CHECK(-20 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_locals_cannot_be_declared_twice)
+    {
+        state_reset();
+        CHECK(ERR_UNKNOWN_WORD == eval(": twice { a } { b } ; "));
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: to
+    //-------------------------------------------------------------------------
+    TEST(Verify_to_stores_the_top_of_the_stack_in_a_local)
+    {
+        state_reset();
+        CHECK(ERR_NONE == eval(": bump { n } n 5 + to n n n * ; 2 bump "));
+        CHECK(49 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_to_throws_if_the_name_is_not_a_local)
+    {
+        state_reset();
+        CHECK(ERR_UNKNOWN_WORD == eval(": bad 1 to n ; "));
+    }
+
+    TEST(Verify_locals_work_in_token_threaded_code)
+    {
+        state_reset();
+        tokens = 1;
+        CHECK(ERR_NONE == eval(": mix { a b c } c to a a b * ; 1 2 3 mix "));
+        tokens = 0;
+        CHECK(NULL != onward_token_code((word_t*)latest));
+        CHECK(6 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+    }
+}
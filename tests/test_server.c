@@ -0,0 +1,208 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+/* The binaries are built by make before the tests run from the top of the
+ * tree */
+#define BIN_PATH   "./onward"
+#define IMAGE_PATH "./onward-image"
+#define WORDS_PATH "source/onward.ft"
+#define SOCK_PATH  "/tmp/onward-test-server.sock"
+
+/* How long to wait for the server to come up or a worker to be replaced */
+#define WAIT_MS 5000
+
+/* A request that emits a single character computed with the loaded words */
+static char const Request[] = "2 cells 48 + emit";
+static char const Response[] = "@";
+
+static void sleep_ms(long ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+/* Run a command with the given input, collecting what it prints */
+static int run_command(char const* cmd, char const* input, char* out, size_t size) {
+    char path[] = "/tmp/onward-test-input-XXXXXX";
+    char line[512];
+    size_t len = 0;
+    FILE* proc;
+    int fd = mkstemp(path);
+    if ((fd < 0) || (write(fd, input, strlen(input)) != (ssize_t)strlen(input))) {
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    close(fd);
+    snprintf(line, sizeof(line), "%s < %s", cmd, path);
+    out[0] = '\0';
+    if ((proc = popen(line, "r"))) {
+        while ((len < (size - 1u)) && fgets(out + len, (int)(size - len), proc))
+            len += strlen(out + len);
+        fd = pclose(proc);
+    }
+    unlink(path);
+    return proc ? fd : -1;
+}
+
+/* Start the interpreter with the given arguments, its output going to the
+ * write end of a pipe if one is given */
+static pid_t start_server(char* const* argv, int out) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null = open("/dev/null", O_RDWR);
+        dup2(null, 0);
+        dup2((out >= 0) ? out : null, 1);
+        dup2(null, 2);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    return pid;
+}
+
+static void stop_server(pid_t pid) {
+    if (pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+    }
+    unlink(SOCK_PATH);
+}
+
+/* Send a request and return non-zero if the expected response came back */
+static int request(void) {
+    struct sockaddr_un addr;
+    char buf[64];
+    size_t len = 0;
+    ssize_t count;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, SOCK_PATH);
+    if ((fd < 0) || connect(fd, (struct sockaddr*)&addr, sizeof(addr))) {
+        if (fd >= 0)
+            close(fd);
+        return 0;
+    }
+    if ((write(fd, Request, sizeof(Request) - 1u) != (ssize_t)(sizeof(Request) - 1u)) ||
+        shutdown(fd, SHUT_WR)) {
+        close(fd);
+        return 0;
+    }
+    while ((len < (sizeof(buf) - 1u)) && ((count = read(fd, buf + len, sizeof(buf) - 1u - len)) > 0))
+        len += (size_t)count;
+    close(fd);
+    buf[len] = '\0';
+    return !strcmp(buf, Response);
+}
+
+/* Wait for the server to answer its first request */
+static int wait_ready(void) {
+    long waited;
+    for (waited = 0; waited < WAIT_MS; waited += 10) {
+        if (request())
+            return 1;
+        sleep_ms(10);
+    }
+    return 0;
+}
+
+#ifdef __linux__
+/* Ask the prefork server for its memory report and read the process ids of
+ * the workers from it, returning how many were read. The workers are only
+ * listed in the report on Linux. */
+static int worker_pids(pid_t server, FILE* out, pid_t* pids, int count) {
+    char line[256];
+    int found = 0;
+    kill(server, SIGUSR1);
+    while (fgets(line, sizeof(line), out)) {
+        if (!strncmp(line, "worker\t", 7) && (found < count))
+            pids[found++] = (pid_t)atoi(line + 7);
+        if (found == count)
+            break;
+    }
+    return found;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Standalone) {
+    //-------------------------------------------------------------------------
+    // Testing: metacompiled image
+    //-------------------------------------------------------------------------
+    TEST(Verify_the_image_runs_the_words_built_into_it)
+    {
+        char out[1024];
+        /* The words of the source are only defined when it is loaded... */
+        CHECK(0 == run_command(BIN_PATH, "2 cells\n", out, sizeof(out)));
+        CHECK(NULL != strstr(out, "errcode: 1"));
+        /* ...but the image has them built in */
+        CHECK(0 == run_command(IMAGE_PATH, "2 cells 7 aligned\n", out, sizeof(out)));
+        CHECK(NULL != strstr(out, "( 0x10 0x8 )"));
+        CHECK(NULL != strstr(out, "errcode: 0"));
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: --serve
+    //-------------------------------------------------------------------------
+    TEST(Verify_the_server_answers_requests_with_the_loaded_words)
+    {
+        char* argv[] = { BIN_PATH, "--serve", SOCK_PATH, "--pool", "2", WORDS_PATH, NULL };
+        pid_t server = start_server(argv, -1);
+        int ready    = wait_ready();
+        int again    = ready && request() && request();
+        stop_server(server);
+        CHECK(server > 0);
+        CHECK(ready);
+        CHECK(again);
+    }
+
+#ifdef __linux__
+    //-------------------------------------------------------------------------
+    // Testing: --prefork
+    //-------------------------------------------------------------------------
+    TEST(Verify_a_prefork_worker_that_dies_is_replaced)
+    {
+        char* argv[] = { BIN_PATH, "--serve", SOCK_PATH, "--prefork", "2", "--pool", "1", WORDS_PATH, NULL };
+        pid_t before[2] = { 0, 0 }, after[2] = { 0, 0 };
+        int fds[2], ready = 0, replaced = 0, served = 0;
+        long waited;
+        FILE* out    = NULL;
+        pid_t server = -1;
+        if (0 == pipe(fds)) {
+            server = start_server(argv, fds[1]);
+            close(fds[1]);
+            out = fdopen(fds[0], "r");
+        }
+        ready = out && wait_ready() && (2 == worker_pids(server, out, before, 2));
+        if (ready && (before[0] > 0)) {
+            kill(before[0], SIGKILL);
+            /* The report may come before the parent has seen the worker exit */
+            for (waited = 0; !replaced && (waited < WAIT_MS); waited += 50) {
+                sleep_ms(50);
+                replaced = ((2 == worker_pids(server, out, after, 2)) &&
+                            (after[0] != before[0]) && (after[1] != before[0]) &&
+                            (after[0] > 0) && (after[1] > 0));
+            }
+            served = request() && request();
+        }
+        stop_server(server);
+        if (out)
+            fclose(out);
+        CHECK(server > 0);
+        CHECK(ready);
+        CHECK(replaced);
+        CHECK(served);
+    }
+#endif
+}
@@ -0,0 +1,98 @@
+// Unit Test Framework Includes
+#include "atf.h"
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+static value_t Greater_Code[] = { W(gt), 0u };
+static const word_t Greater_Word = { 0u, 0u, "greater-word", Greater_Code };
+
+static value_t Data[1000];
+
+static void fill(value_t count, value_t seed) {
+    value_t i;
+    for (i = 0; i < count; i++) {
+        seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+        Data[i] = (seed % 2001) - 1000;
+    }
+}
+
+static bool ordered(value_t count, bool descending) {
+    value_t i;
+    for (i = 1; i < count; i++) {
+        if (descending ? (Data[i-1] < Data[i]) : (Data[i-1] > Data[i]))
+            return false;
+    }
+    return true;
+}
+
+static void sort_with(value_t count, word_t const* word) {
+    onward_aspush((value_t)Data);
+    onward_aspush(count);
+    if (word) {
+        onward_aspush((value_t)word);
+        ((primitive_t)sort.code)();
+    } else {
+        ((primitive_t)radix_sort.code)();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Sorting) {
+    //-------------------------------------------------------------------------
+    // Testing: sort
+    //-------------------------------------------------------------------------
+    TEST(Verify_sort_orders_cells_with_a_primitive_comparison)
+    {
+        state_reset();
+        fill(1000, 1);
+        sort_with(1000, &lt);
+        CHECK(ordered(1000, false));
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_sort_orders_cells_with_a_colon_definition)
+    {
+        state_reset();
+        fill(1000, 2);
+        sort_with(1000, &Greater_Word);
+        CHECK(ordered(1000, true));
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_sort_handles_presorted_and_uniform_arrays)
+    {
+        value_t i;
+        state_reset();
+        for (i = 0; i < 1000; i++)
+            Data[i] = 1000 - i;
+        sort_with(1000, &lt);
+        CHECK(ordered(1000, false));
+        for (i = 0; i < 1000; i++)
+            Data[i] = 7;
+        sort_with(1000, &lt);
+        CHECK(7 == Data[0] && 7 == Data[999]);
+        sort_with(0, &lt);
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: radix-sort
+    //-------------------------------------------------------------------------
+    TEST(Verify_radix_sort_orders_signed_cells)
+    {
+        state_reset();
+        fill(1000, 3);
+        Data[10] = ((value_t)1 << (CELL_BITS - 2u));
+        Data[20] = -Data[10];
+        sort_with(1000, NULL);
+        CHECK(ordered(1000, false));
+        CHECK(Data[0] == -((value_t)1 << (CELL_BITS - 2u)));
+        CHECK(Data[999] == ((value_t)1 << (CELL_BITS - 2u)));
+        CHECK(asb == asp);
+    }
+}
@@ -0,0 +1,158 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <string.h>
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+static char Line[] = "GET /index.html 200  ";
+
+static void exec_prim(const word_t* word) {
+    ((primitive_t)word->code)();
+}
+
+static void push_slice(char const* str) {
+    onward_aspush((value_t)str);
+    onward_aspush((value_t)strlen(str));
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(String_Slices) {
+    //-------------------------------------------------------------------------
+    // Testing: /string
+    //-------------------------------------------------------------------------
+    TEST(Verify_slash_string_advances_the_start_of_the_string)
+    {
+        state_reset();
+        push_slice(Line);
+        onward_aspush(4);
+        exec_prim(&slash_string);
+        CHECK(17 == onward_aspop());
+        CHECK((value_t)(Line + 4) == onward_aspop());
+        push_slice(Line);
+        onward_aspush(100);
+        exec_prim(&slash_string);
+        CHECK(0 == onward_aspop());
+        CHECK((value_t)(Line + 21) == onward_aspop());
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: -trailing
+    //-------------------------------------------------------------------------
+    TEST(Verify_dash_trailing_excludes_trailing_whitespace)
+    {
+        state_reset();
+        push_slice(Line);
+        exec_prim(&dash_trailing);
+        CHECK(19 == onward_aspop());
+        CHECK((value_t)Line == onward_aspop());
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: split
+    //-------------------------------------------------------------------------
+    TEST(Verify_split_returns_the_parts_before_and_after_the_delimiter)
+    {
+        state_reset();
+        push_slice(Line);
+        onward_aspush(' ');
+        exec_prim(&split);
+        CHECK(3 == onward_aspop());
+        CHECK((value_t)Line == onward_aspop());
+        CHECK(17 == onward_aspop());
+        CHECK((value_t)(Line + 4) == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_split_returns_the_whole_string_if_the_delimiter_is_missing)
+    {
+        state_reset();
+        push_slice(Line);
+        onward_aspush(',');
+        exec_prim(&split);
+        CHECK(21 == onward_aspop());
+        CHECK((value_t)Line == onward_aspop());
+        CHECK(0 == onward_aspop());
+        CHECK((value_t)(Line + 21) == onward_aspop());
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: search
+    //-------------------------------------------------------------------------
+    TEST(Verify_search_returns_the_remainder_starting_at_the_match)
+    {
+        state_reset();
+        push_slice(Line);
+        push_slice(".html");
+        exec_prim(&search);
+        CHECK(1 == onward_aspop());
+        CHECK(11 == onward_aspop());
+        CHECK((value_t)(Line + 10) == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_search_returns_the_string_if_there_is_no_match)
+    {
+        state_reset();
+        push_slice(Line);
+        push_slice("POST");
+        exec_prim(&search);
+        CHECK(0 == onward_aspop());
+        CHECK(21 == onward_aspop());
+        CHECK((value_t)Line == onward_aspop());
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: compare
+    //-------------------------------------------------------------------------
+    TEST(Verify_compare_orders_strings_by_bytes_then_length)
+    {
+        state_reset();
+        onward_aspush((value_t)Line);
+        onward_aspush(3);
+        push_slice("GET");
+        exec_prim(&compare);
+        CHECK(0 == onward_aspop());
+        onward_aspush((value_t)Line);
+        onward_aspush(3);
+        push_slice("GETS");
+        exec_prim(&compare);
+        CHECK(-1 == onward_aspop());
+        push_slice("PUT");
+        push_slice("GET");
+        exec_prim(&compare);
+        CHECK(1 == onward_aspop());
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: snum
+    //-------------------------------------------------------------------------
+    TEST(Verify_snum_parses_a_number_from_a_slice)
+    {
+        state_reset();
+        onward_aspush((value_t)(Line + 16));
+        onward_aspush(3);
+        exec_prim(&snum);
+        CHECK(1 == onward_aspop());
+        CHECK(200 == onward_aspop());
+        push_slice("-0x1F");
+        exec_prim(&snum);
+        CHECK(1 == onward_aspop());
+        CHECK(-31 == onward_aspop());
+    }
+
+    TEST(Verify_snum_returns_the_slice_if_it_is_not_a_number)
+    {
+        state_reset();
+        onward_aspush((value_t)(Line + 16));
+        onward_aspush(4);
+        exec_prim(&snum);
+        CHECK(0 == onward_aspop());
+        CHECK(4 == onward_aspop());
+        CHECK((value_t)(Line + 16) == onward_aspop());
+    }
+}
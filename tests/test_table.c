@@ -0,0 +1,186 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <string.h>
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+static value_t Sum_Code[] = { W(add), W(lit), 0, W(swap), W(add_store), 0u };
+static const word_t Sum_Word = { 0u, 0u, "sum-word", Sum_Code };
+
+static value_t Table_Buf[64];
+
+static void exec_prim(const word_t* word) {
+    ((primitive_t)word->code)();
+}
+
+static value_t new_table(value_t limit, bool strings) {
+    state_reset();
+    onward_aspush(limit);
+    exec_prim(strings ? &strtable : &table);
+    return onward_aspop();
+}
+
+static void tbl_store(value_t tbl, value_t key, value_t val) {
+    onward_aspush(val);
+    onward_aspush(key);
+    onward_aspush(tbl);
+    exec_prim(&table_store);
+}
+
+static value_t tbl_fetch(value_t tbl, value_t key) {
+    onward_aspush(key);
+    onward_aspush(tbl);
+    exec_prim(&table_fetch);
+    return onward_aspop() ? onward_aspop() : (onward_aspop(), -1);
+}
+
+static value_t tbl_del(value_t tbl, value_t key) {
+    onward_aspush(key);
+    onward_aspush(tbl);
+    exec_prim(&table_delete);
+    return onward_aspop();
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Hash_Tables) {
+    //-------------------------------------------------------------------------
+    // Testing: table! table@
+    //-------------------------------------------------------------------------
+    TEST(Verify_table_stores_and_replaces_values_by_cell_key)
+    {
+        value_t tbl = new_table(8, false);
+        CHECK(here > tbl);
+        tbl_store(tbl, 10, 100);
+        tbl_store(tbl, -3, 30);
+        tbl_store(tbl, 10, 101);
+        CHECK(101 == tbl_fetch(tbl, 10));
+        CHECK(30 == tbl_fetch(tbl, -3));
+        CHECK(-1 == tbl_fetch(tbl, 11));
+        onward_aspush(tbl);
+        exec_prim(&table_count);
+        CHECK(2 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_table_throws_when_full)
+    {
+        value_t tbl = new_table(2, false);
+        tbl_store(tbl, 1, 1);
+        tbl_store(tbl, 2, 2);
+        tbl_store(tbl, 3, 3);
+        CHECK(ERR_TABLE_FULL == errcode);
+        CHECK(-1 == tbl_fetch(tbl, 3));
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: table-del
+    //-------------------------------------------------------------------------
+    TEST(Verify_table_delete_keeps_colliding_keys_reachable)
+    {
+        value_t i;
+        value_t tbl = new_table(64, false);
+        for (i = 0; i < 64; i++)
+            tbl_store(tbl, i * 16, i);
+        for (i = 0; i < 64; i += 2)
+            CHECK(1 == tbl_del(tbl, i * 16));
+        CHECK(0 == tbl_del(tbl, 0));
+        for (i = 0; i < 64; i++)
+            CHECK(((i % 2) ? i : -1) == tbl_fetch(tbl, i * 16));
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: strtable
+    //-------------------------------------------------------------------------
+    TEST(Verify_strtable_compares_the_bytes_of_keys)
+    {
+        char key1[] = "alpha", key2[] = "alpha", key3[] = "alphabet";
+        value_t tbl = new_table(4, true);
+        onward_aspush(1);
+        onward_aspush((value_t)key1);
+        onward_aspush(5);
+        onward_aspush(tbl);
+        exec_prim(&table_store);
+        onward_aspush((value_t)key2);
+        onward_aspush(5);
+        onward_aspush(tbl);
+        exec_prim(&table_fetch);
+        CHECK(1 == onward_aspop());
+        CHECK(1 == onward_aspop());
+        onward_aspush((value_t)key3);
+        onward_aspush(8);
+        onward_aspush(tbl);
+        exec_prim(&table_fetch);
+        CHECK(0 == onward_aspop());
+        CHECK(0 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: table sizes
+    //-------------------------------------------------------------------------
+    TEST(Verify_table_rejects_sizes_that_are_not_positive_or_too_large)
+    {
+        value_t start;
+        state_reset();
+        start = here;
+        CHECK(ERR_BAD_SIZE == onward_eval("0 table", 7));
+        CHECK(ERR_BAD_SIZE == onward_eval("-1 table", 8));
+        onward_aspush(~(value_t)0 ^ ((value_t)1 << (CELL_BITS - 1)));
+        CHECK(ERR_BAD_SIZE == onward_eval("table-bytes", 11));
+        CHECK(start == here);
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_table_throws_if_it_does_not_fit_in_the_dictionary)
+    {
+        value_t start;
+        state_reset();
+        start = here;
+        CHECK(ERR_DICT_FULL == onward_eval("100000 table", 12));
+        CHECK(start == here);
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: table-init
+    //-------------------------------------------------------------------------
+    TEST(Verify_table_init_uses_the_given_memory)
+    {
+        state_reset();
+        onward_aspush(4);
+        exec_prim(&table_bytes);
+        CHECK(sizeof(Table_Buf) >= (size_t)onward_aspeek(0));
+        (void)onward_aspop();
+        onward_aspush((value_t)Table_Buf);
+        onward_aspush(4);
+        onward_aspush(0);
+        exec_prim(&table_init);
+        CHECK((value_t)Table_Buf == onward_aspeek(0));
+        tbl_store((value_t)Table_Buf, 5, 50);
+        CHECK(50 == tbl_fetch((value_t)Table_Buf, 5));
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: table-each
+    //-------------------------------------------------------------------------
+    TEST(Verify_table_each_visits_every_key)
+    {
+        value_t sum = 0;
+        value_t tbl = new_table(8, false);
+        Sum_Code[2] = (value_t)&sum;
+        tbl_store(tbl, 1, 10);
+        tbl_store(tbl, 2, 20);
+        tbl_store(tbl, 3, 30);
+        onward_aspush(tbl);
+        onward_aspush((value_t)&Sum_Word);
+        exec_prim(&table_each);
+        CHECK(66 == sum);
+        CHECK(asb == asp);
+    }
+}
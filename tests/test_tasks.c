@@ -0,0 +1,326 @@
+// Unit Test Framework Includes
+#include "atf.h"
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+static value_t Task_Code[] = { W(lit), 7, W(_pause), W(lit), 8, 0u };
+static const word_t Task_Word = { 0u, 0u, "task-word", Task_Code };
+
+static value_t Main_Code[] = { W(_pause), 0u };
+static const word_t Main_Word = { 0u, 0u, "main-word", Main_Code };
+
+static value_t Square_Code[] = { W(_dup), W(mul), 0u };
+static const word_t Square_Word = { 0u, 0u, "square", Square_Code };
+
+static value_t Exec_Code[] = { W(lit), 3, W(lit), (value_t)&Square_Word, W(exec), W(lit), 1, W(add), 0u };
+static const word_t Exec_Word = { 0u, 0u, "exec-word", Exec_Code };
+
+static value_t Exec_Pause_Code[] = { W(lit), (value_t)&Main_Word, W(exec), 0u };
+static const word_t Exec_Pause_Word = { 0u, 0u, "exec-pause-word", Exec_Pause_Code };
+
+static value_t Throw_Code[] = { W(lit), 9, W(_throw), 0u };
+static const word_t Throw_Word = { 0u, 0u, "throw-nine", Throw_Code };
+
+static value_t Seven_Code[] = { W(lit), 7, 0u };
+static const word_t Seven_Word = { 0u, 0u, "seven", Seven_Code };
+
+/* Throws 7 for cells over 900 and adds 1 to the others */
+static value_t Bad_Code[] = { W(_dup), W(lit), 900, W(gt), W(lit), 7, W(mul), W(_throw), W(lit), 1, W(add), 0u };
+static const word_t Bad_Word = { 0u, 0u, "bad", Bad_Code };
+
+/* Throws 7 for cells over 900 and adds the others */
+static value_t Bad_Add_Code[] = { W(_dup), W(lit), 900, W(gt), W(lit), 7, W(mul), W(_throw), W(add), 0u };
+static const word_t Bad_Add_Word = { 0u, 0u, "bad-add", Bad_Add_Code };
+
+static value_t Par_Data[1000];
+
+static void par_fill(void) {
+    value_t i;
+    for (i = 0; i < 1000; i++)
+        Par_Data[i] = i;
+}
+
+static void par_set_threads(value_t count) {
+    onward_aspush(count);
+    ((primitive_t)par_threads.code)();
+}
+
+/* Run par-map on Par_Data with catch, returning the code it pushes. The
+ * arguments restored by catch on an error are dropped. */
+static value_t par_map_catch(word_t const* word) {
+    value_t code;
+    onward_aspush((value_t)Par_Data);
+    onward_aspush(1000);
+    onward_aspush((value_t)word);
+    onward_aspush((value_t)&par_map);
+    onward_exec(&_catch);
+    code = onward_aspop();
+    if (code)
+        asp -= 3 * sizeof(value_t);
+    return code;
+}
+
+static value_t task_pop(task_t* task) {
+    value_t val = *((value_t*)task->asp);
+    task->asp -= sizeof(value_t);
+    return val;
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Multitasking) {
+    //-------------------------------------------------------------------------
+    // Testing: spawn
+    //-------------------------------------------------------------------------
+    TEST(Verify_spawn_schedules_a_task_with_its_own_stacks)
+    {
+        state_reset();
+        onward_aspush((value_t)&Task_Word);
+        onward_aspush(8);
+        ((primitive_t)spawn.code)();
+        task_t* task = (task_t*)onward_aspop();
+        CHECK(asb == asp);
+        CHECK(task->asb == task->asp);
+        CHECK((value_t)(8 * sizeof(value_t)) == task->assz);
+        CHECK(here == (value_t)(task + 1) + (value_t)(16 * sizeof(value_t)));
+        ((primitive_t)tasks.code)();
+        CHECK(1 == onward_aspop());
+        /* Run the task to completion so it leaves the schedule */
+        onward_exec(&Main_Word);
+        onward_exec(&Main_Word);
+    }
+
+    TEST(Verify_spawn_rejects_stack_sizes_that_are_not_positive_or_too_large)
+    {
+        value_t start;
+        value_t sizes[] = { 0, -1, -(value_t)(1 << 20), (value_t)(((uvalue_t)1u << (CELL_BITS - 1u)) / sizeof(value_t)) };
+        size_t i;
+        for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            state_reset();
+            start = here;
+            onward_aspush((value_t)&Task_Word);
+            onward_aspush(sizes[i]);
+            ((primitive_t)spawn.code)();
+            CHECK(ERR_BAD_SIZE == errcode);
+            CHECK(start == here);
+            CHECK(asb == asp);
+            ((primitive_t)tasks.code)();
+            CHECK(0 == onward_aspop());
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: pause
+    //-------------------------------------------------------------------------
+    TEST(Verify_pause_switches_between_tasks_until_they_stop)
+    {
+        state_reset();
+        onward_aspush((value_t)&Task_Word);
+        onward_aspush(8);
+        ((primitive_t)spawn.code)();
+        task_t* task = (task_t*)onward_aspop();
+        onward_aspush(42);
+        onward_exec(&Main_Word);
+        CHECK(42 == onward_aspop());
+        CHECK(7 == task_pop(task));
+        ((primitive_t)tasks.code)();
+        CHECK(1 == onward_aspop());
+        onward_exec(&Main_Word);
+        ((primitive_t)tasks.code)();
+        CHECK(0 == onward_aspop());
+        CHECK(8 == task_pop(task));
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_an_uncaught_error_stops_the_task_and_the_host_runs_on)
+    {
+        state_reset();
+        onward_aspush((value_t)&Throw_Word);
+        onward_aspush(8);
+        ((primitive_t)spawn.code)();
+        (void)onward_aspop();
+        onward_aspush(1);
+        onward_aspush(2);
+        onward_aspush(3);
+        onward_exec(&Main_Word);
+        CHECK(9 == errcode);
+        CHECK(3 == onward_aspop());
+        CHECK(2 == onward_aspop());
+        CHECK(1 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+        ((primitive_t)tasks.code)();
+        CHECK(0 == onward_aspop());
+        /* The host can still switch and run further tasks */
+        errcode = 0;
+        onward_aspush((value_t)&Seven_Word);
+        onward_aspush(8);
+        ((primitive_t)spawn.code)();
+        task_t* task = (task_t*)onward_aspop();
+        onward_exec(&Main_Word);
+        CHECK(0 == errcode);
+        CHECK(7 == task_pop(task));
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: stop
+    //-------------------------------------------------------------------------
+    TEST(Verify_stop_does_nothing_in_the_host_task)
+    {
+        state_reset();
+        onward_aspush(1);
+        ((primitive_t)stop.code)();
+        CHECK(1 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_task_code_ends_after_stop)
+    {
+        state_reset();
+        onward_aspush((value_t)&Seven_Word);
+        onward_aspush(8);
+        ((primitive_t)spawn.code)();
+        task_t* task = (task_t*)onward_aspop();
+        word_t code_word = { 0u, 0u, "task-code", task->code };
+        /* Stop does not switch away from the host task so the code must end */
+        onward_exec(&code_word);
+        CHECK(7 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+        onward_exec(&Main_Word);
+        ((primitive_t)tasks.code)();
+        CHECK(0 == onward_aspop());
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: exec
+    //-------------------------------------------------------------------------
+    TEST(Verify_exec_runs_the_word_to_completion_before_the_next_instruction)
+    {
+        state_reset();
+        onward_exec(&Exec_Word);
+        CHECK(10 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_exec_lets_the_word_pause)
+    {
+        state_reset();
+        onward_aspush((value_t)&Task_Word);
+        onward_aspush(8);
+        ((primitive_t)spawn.code)();
+        task_t* task = (task_t*)onward_aspop();
+        onward_exec(&Exec_Pause_Word);
+        CHECK(7 == task_pop(task));
+        onward_exec(&Main_Word);
+        ((primitive_t)tasks.code)();
+        CHECK(0 == onward_aspop());
+        CHECK(8 == task_pop(task));
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: par-map
+    //-------------------------------------------------------------------------
+    TEST(Verify_par_map_applies_a_word_to_every_cell_across_threads)
+    {
+        value_t i;
+        state_reset();
+        for (i = 0; i < 1000; i++)
+            Par_Data[i] = i;
+        onward_aspush(4);
+        ((primitive_t)par_threads.code)();
+        onward_aspush((value_t)Par_Data);
+        onward_aspush(1000);
+        onward_aspush((value_t)&Square_Word);
+        ((primitive_t)par_map.code)();
+        for (i = 0; i < 1000; i++)
+            CHECK(i * i == Par_Data[i]);
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: par-reduce
+    //-------------------------------------------------------------------------
+    TEST(Verify_par_reduce_combines_every_cell_across_threads)
+    {
+        value_t i;
+        state_reset();
+        for (i = 0; i < 1000; i++)
+            Par_Data[i] = i;
+        onward_aspush(4);
+        ((primitive_t)par_threads.code)();
+        onward_aspush((value_t)Par_Data);
+        onward_aspush(1000);
+        onward_aspush(0);
+        onward_aspush((value_t)&add);
+        ((primitive_t)par_reduce.code)();
+        CHECK(499500 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_par_reduce_passes_on_an_error_thrown_by_the_word)
+    {
+        state_reset();
+        par_fill();
+        par_set_threads(4);
+        onward_aspush((value_t)Par_Data);
+        onward_aspush(1000);
+        onward_aspush(0);
+        onward_aspush((value_t)&Bad_Add_Word);
+        onward_aspush((value_t)&par_reduce);
+        onward_exec(&_catch);
+        CHECK(7 == onward_aspop());
+        CHECK((asb + (4 * (value_t)sizeof(value_t))) == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: par-map errors and limits
+    //-------------------------------------------------------------------------
+    TEST(Verify_par_map_passes_on_an_error_thrown_on_any_thread)
+    {
+        value_t run;
+        for (run = 0; run < 20; run++) {
+            state_reset();
+            par_fill();
+            par_set_threads(4);
+            CHECK(7 == par_map_catch(&Bad_Word));
+            CHECK(asb == asp);
+        }
+        /* The pool is left ready for the next job */
+        state_reset();
+        par_fill();
+        CHECK(0 == par_map_catch(&Square_Word));
+        CHECK(999 * 999 == Par_Data[999]);
+    }
+
+    TEST(Verify_par_map_workers_added_later_only_run_new_jobs)
+    {
+        value_t i, run;
+        for (run = 0; run < 20; run++) {
+            state_reset();
+            par_set_threads(2 + (run % 3));
+            par_fill();
+            CHECK(0 == par_map_catch(&Square_Word));
+            for (i = 0; i < 1000; i++)
+                CHECK(i * i == Par_Data[i]);
+        }
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_par_map_is_held_to_the_limits_of_the_evaluation)
+    {
+        state_reset();
+        par_fill();
+        par_set_threads(4);
+        onward_limit(100, 0, 0);
+        CHECK(ERR_OUT_OF_FUEL == par_map_catch(&Square_Word));
+        CHECK(asb == asp);
+        onward_limit(0, 0, 0);
+    }
+}
@@ -0,0 +1,172 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <string.h>
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+deccode(utime);
+deccode(ntime);
+deccode(rdtsc);
+deccode(bench);
+deccode(perf);
+
+static value_t Arg_Stack[32];
+static value_t Ret_Stack[32];
+static value_t Word_Buf[256];
+
+/* The output of the words run in the timing instance */
+static char Output[1024];
+static size_t Output_Len;
+
+static void output_char(value_t ch) {
+    if (Output_Len < (sizeof(Output) - 1u))
+        Output[Output_Len++] = (char)ch;
+    Output[Output_Len] = '\0';
+}
+
+/* Counts the number of times it is executed */
+static value_t Calls;
+
+static void count_call(void) {
+    Calls++;
+}
+
+static const word_t Count_Word = { 0u, F_PRIMITIVE_MSK, "count-call", (value_t*)&count_call };
+
+/* Set up an instance with the words of the standalone interpreter that
+ * collects its output */
+static void timing_reset(onward_vm_t* vm) {
+    onward_init_t init = {
+        Arg_Stack, sizeof(Arg_Stack),
+        Ret_Stack, sizeof(Ret_Stack),
+        Word_Buf,  sizeof(Word_Buf),
+        (word_t*)&perf, 0u, output_char
+    };
+    onward_vm_init(vm, &init);
+    Output_Len = 0;
+    Output[0]  = '\0';
+    Calls      = 0;
+}
+
+static value_t timing_eval(onward_vm_t* vm, char const* source) {
+    return onward_vm_eval(vm, source, (value_t)strlen(source));
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Timing) {
+    //-------------------------------------------------------------------------
+    // Testing: utime ntime rdtsc
+    //-------------------------------------------------------------------------
+    TEST(Verify_the_clocks_never_run_backwards)
+    {
+        onward_vm_t vm;
+        value_t i, prev[3] = { 0, 0, 0 };
+        state_reset();
+        timing_reset(&vm);
+        for (i = 0; i < 100; i++) {
+            CHECK(ERR_NONE == timing_eval(&vm, "utime ntime rdtsc"));
+            CHECK(3 == onward_vm_depth(&vm));
+            value_t cycles = onward_vm_pop(&vm);
+            value_t ns     = onward_vm_pop(&vm);
+            value_t us     = onward_vm_pop(&vm);
+            CHECK(us >= prev[0]);
+            CHECK(ns >= prev[1]);
+            CHECK((uvalue_t)cycles >= (uvalue_t)prev[2]);
+            /* The clocks are read in order so ntime is at least utime */
+            CHECK((ns / 1000) >= us);
+            prev[0] = us;
+            prev[1] = ns;
+            prev[2] = cycles;
+        }
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: bench
+    //-------------------------------------------------------------------------
+    TEST(Verify_bench_runs_the_word_and_consumes_its_arguments)
+    {
+        onward_vm_t vm;
+        state_reset();
+        timing_reset(&vm);
+        onward_vm_push(&vm, 1);
+        onward_vm_push(&vm, (value_t)&Count_Word);
+        onward_vm_push(&vm, 25);
+        CHECK(ERR_NONE == timing_eval(&vm, "bench"));
+        CHECK(25 == Calls);
+        CHECK(1 == onward_vm_depth(&vm));
+        CHECK(1 == onward_vm_pop(&vm));
+        CHECK(NULL != strstr(Output, "runs: 25\t"));
+        CHECK(NULL != strstr(Output, "median: "));
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_bench_prints_nothing_for_no_runs)
+    {
+        onward_vm_t vm;
+        state_reset();
+        timing_reset(&vm);
+        onward_vm_push(&vm, (value_t)&Count_Word);
+        onward_vm_push(&vm, 0);
+        CHECK(ERR_NONE == timing_eval(&vm, "bench"));
+        CHECK(0 == Calls);
+        CHECK(0 == onward_vm_depth(&vm));
+        CHECK(0 == Output_Len);
+    }
+
+    TEST(Verify_bench_passes_on_an_error_thrown_by_the_word)
+    {
+        onward_vm_t vm;
+        state_reset();
+        timing_reset(&vm);
+        CHECK(ERR_ARG_STACK_UNDRFLW == timing_eval(&vm, "' drop 3 bench"));
+        CHECK(0 == onward_vm_depth(&vm));
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: perf
+    //-------------------------------------------------------------------------
+    TEST(Verify_perf_reports_each_counter_or_that_it_is_unavailable)
+    {
+        static char const* const names[] = { "instructions:\t", "cache-misses:\t", "branch-misses:\t" };
+        onward_vm_t vm;
+        size_t i;
+        state_reset();
+        timing_reset(&vm);
+        onward_vm_push(&vm, (value_t)&Count_Word);
+        onward_vm_push(&vm, 10);
+        CHECK(ERR_NONE == timing_eval(&vm, "perf"));
+        CHECK(10 == Calls);
+        CHECK(0 == onward_vm_depth(&vm));
+        CHECK(0 == strncmp(Output, "time:\t\t", 7));
+#ifdef __linux__
+        /* Counters that cannot be opened, such as without permission to use
+         * perf_event_open, are reported rather than failing the word */
+        for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            char const* line = strstr(Output, names[i]);
+            CHECK(NULL != line);
+            line += strlen(names[i]);
+            CHECK(!strncmp(line, "unavailable\n", 12) || (NULL != strstr(line, " per call\n")));
+        }
+#else
+        (void)names;
+        (void)i;
+        CHECK(NULL == strstr(Output, "instructions"));
+#endif
+    }
+
+    TEST(Verify_perf_passes_on_an_error_thrown_by_the_word)
+    {
+        onward_vm_t vm;
+        state_reset();
+        timing_reset(&vm);
+        CHECK(ERR_ARG_STACK_UNDRFLW == timing_eval(&vm, "' drop 3 perf"));
+        CHECK(0 == onward_vm_depth(&vm));
+        CHECK(NULL != strstr(Output, "time:"));
+    }
+}
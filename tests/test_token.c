@@ -0,0 +1,190 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <pthread.h>
+#include <string.h>
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+/* ( n -- n' ) Pushes 7 if n is greater than 1, otherwise 100000 */
+static value_t Branch_Code[] = {
+    W(lit), 1, W(gt), W(zbr), 5 * sizeof(value_t),
+    W(lit), 7, W(br), 3 * sizeof(value_t),
+    W(lit), 100000, 0u
+};
+static word_t Branch_Word = { 0u, 0u, "branch-word", Branch_Code };
+
+static value_t Square_Code[] = { W(_dup), W(mul), 0u };
+static word_t Square_Word = { 0u, 0u, "square", Square_Code };
+
+static value_t Tick_Code[] = { W(tick), (value_t)&Square_Word, W(exec), 0u };
+static word_t Tick_Word = { 0u, 0u, "tick-word", Tick_Code };
+
+static value_t Throw_Code[] = { W(lit), -5, W(_throw), W(lit), 2, 0u };
+static word_t Throw_Word = { 0u, 0u, "throw-word", Throw_Code };
+
+static value_t Catch_Code[] = { W(tick), (value_t)&Throw_Word, W(_catch), 0u };
+static word_t Catch_Word = { 0u, 0u, "catch-word", Catch_Code };
+
+/* Words that are tokenized by several threads at once */
+#define SHARED_THREADS 4
+static value_t Shared_Code[] = {
+    W(nrot), W(pick), W(roll), W(two_swap), W(ne), W(lte), W(gte), W(band),
+    W(bor), W(bxor), W(bnot), W(umul), W(mmul), W(byte_fetch), W(byte_store),
+    W(add_store), W(sub_store), W(dup_if), W(two_dup), W(two_drop), 0u
+};
+static value_t Shared_Tokens[SHARED_THREADS][sizeof(Shared_Code) / sizeof(value_t)];
+
+/* Tokenize a copy of the shared code in a dictionary of the thread's own */
+static void* shared_thread(void* arg) {
+    value_t index = (value_t)arg;
+    value_t arg_stack[16], ret_stack[16], word_buf[256];
+    value_t code[sizeof(Shared_Code) / sizeof(value_t)];
+    word_t word = { 0u, 0u, "shared-word", code };
+    uint16_t const* toks;
+    value_t i;
+    onward_init_t init = {
+        arg_stack, sizeof(arg_stack),
+        ret_stack, sizeof(ret_stack),
+        word_buf, sizeof(word_buf),
+        NULL, NULL, NULL
+    };
+    onward_init(&init);
+    memcpy(code, Shared_Code, sizeof(code));
+    if (onward_tokenize(&word) && (toks = onward_token_code(&word))) {
+        for (i = 0; toks[i] != TOKEN_EXIT; i++)
+            Shared_Tokens[index][i] = toks[i];
+    }
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Token_Threading) {
+    //-------------------------------------------------------------------------
+    // Testing: tokenize
+    //-------------------------------------------------------------------------
+    TEST(Verify_tokenize_translates_literals_and_branches)
+    {
+        state_reset();
+        Branch_Word.code = Branch_Code;
+        onward_aspush((value_t)&Branch_Word);
+        ((primitive_t)tokenize.code)();
+        CHECK(1 == onward_aspop());
+        CHECK(NULL != onward_token_code(&Branch_Word));
+        onward_aspush(5);
+        onward_exec(&Branch_Word);
+        CHECK(7 == onward_aspop());
+        onward_aspush(0);
+        onward_exec(&Branch_Word);
+        CHECK(100000 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_tokenize_calls_token_words_and_pushes_ticked_words)
+    {
+        state_reset();
+        Square_Word.code = Square_Code;
+        Tick_Word.code   = Tick_Code;
+        CHECK(1 == onward_tokenize(&Square_Word));
+        CHECK(1 == onward_tokenize(&Tick_Word));
+        onward_aspush(9);
+        onward_exec(&Tick_Word);
+        CHECK(81 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+    }
+
+    TEST(Verify_tokenize_skips_primitives_and_converted_words)
+    {
+        state_reset();
+        Square_Word.code = Square_Code;
+        CHECK(0 == onward_tokenize((word_t*)&add));
+        CHECK(1 == onward_tokenize(&Square_Word));
+        CHECK(0 == onward_tokenize(&Square_Word));
+    }
+
+    TEST(Verify_tokenize_rewrites_the_latest_word_in_place)
+    {
+        value_t i, cell_here;
+        state_reset();
+        onward_aspush((value_t)"sum");
+        ((primitive_t)create.code)();
+        for (i = 0; i < 8; i++) {
+            onward_aspush(W(lit));
+            ((primitive_t)comma.code)();
+            onward_aspush(i);
+            ((primitive_t)comma.code)();
+        }
+        for (i = 0; i < 7; i++) {
+            onward_aspush(W(add));
+            ((primitive_t)comma.code)();
+        }
+        ((primitive_t)semicolon.code)();
+        cell_here = here;
+        CHECK(1 == onward_tokenize((word_t*)latest));
+        CHECK(here < cell_here);
+        CHECK((value_t)((word_t*)latest)->code == (value_t)((word_t*)latest + 1));
+        onward_exec((word_t*)latest);
+        CHECK(28 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_tokens_register_converts_new_definitions)
+    {
+        state_reset();
+        tokens = 1;
+        onward_aspush((value_t)"cube");
+        ((primitive_t)create.code)();
+        onward_aspush(W(_dup));
+        ((primitive_t)comma.code)();
+        onward_aspush(W(_dup));
+        ((primitive_t)comma.code)();
+        onward_aspush(W(mul));
+        ((primitive_t)comma.code)();
+        onward_aspush(W(mul));
+        ((primitive_t)comma.code)();
+        ((primitive_t)semicolon.code)();
+        tokens = 0;
+        CHECK(NULL != onward_token_code((word_t*)latest));
+        onward_aspush(3);
+        onward_exec((word_t*)latest);
+        CHECK(27 == onward_aspop());
+    }
+
+    TEST(Verify_errors_thrown_by_token_words_are_caught)
+    {
+        state_reset();
+        Throw_Word.code = Throw_Code;
+        Catch_Word.code = Catch_Code;
+        CHECK(1 == onward_tokenize(&Throw_Word));
+        CHECK(1 == onward_tokenize(&Catch_Word));
+        onward_aspush(1);
+        onward_exec(&Catch_Word);
+        CHECK(-5 == onward_aspop());
+        CHECK(1 == onward_aspop());
+        CHECK(asb == asp);
+        CHECK(rsb == rsp);
+        CHECK(0 == handler);
+    }
+
+    TEST(Verify_threads_tokenizing_at_once_agree_on_the_tokens)
+    {
+        pthread_t threads[SHARED_THREADS];
+        value_t i, j;
+        memset(Shared_Tokens, 0, sizeof(Shared_Tokens));
+        for (i = 0; i < SHARED_THREADS; i++)
+            pthread_create(&threads[i], NULL, shared_thread, (void*)i);
+        for (i = 0; i < SHARED_THREADS; i++)
+            pthread_join(threads[i], NULL);
+        for (j = 0; Shared_Code[j]; j++) {
+            CHECK(Shared_Code[j] == (value_t)onward_token_word(Shared_Tokens[0][j]));
+            for (i = 1; i < SHARED_THREADS; i++)
+                CHECK(Shared_Tokens[0][j] == Shared_Tokens[i][j]);
+        }
+    }
+}
@@ -0,0 +1,229 @@
+// Unit Test Framework Includes
+#include "atf.h"
+#include <string.h>
+
+// File To Test
+#include "onward.h"
+
+void state_reset(void);
+
+static value_t Arg_Stack[32];
+static value_t Ret_Stack[32];
+static value_t Word_Buf[256];
+static value_t Other_Arg_Stack[32];
+static value_t Other_Ret_Stack[32];
+static value_t Other_Word_Buf[256];
+
+static void vm_reset(onward_vm_t* vm) {
+    onward_init_t init = {
+        Arg_Stack, sizeof(Arg_Stack),
+        Ret_Stack, sizeof(Ret_Stack),
+        Word_Buf,  sizeof(Word_Buf),
+        0u, 0u, 0u
+    };
+    onward_vm_init(vm, &init);
+}
+
+static void vm_reset_other(onward_vm_t* vm) {
+    onward_init_t init = {
+        Other_Arg_Stack, sizeof(Other_Arg_Stack),
+        Other_Ret_Stack, sizeof(Other_Ret_Stack),
+        Other_Word_Buf,  sizeof(Other_Word_Buf),
+        0u, 0u, 0u
+    };
+    onward_vm_init(vm, &init);
+}
+
+//-----------------------------------------------------------------------------
+// Begin Unit Tests
+//-----------------------------------------------------------------------------
+TEST_SUITE(Embedding) {
+    //-------------------------------------------------------------------------
+    // Testing: onward_vm_eval
+    //-------------------------------------------------------------------------
+    TEST(Verify_eval_interprets_the_given_buffer)
+    {
+        onward_vm_t vm;
+        state_reset();
+        vm_reset(&vm);
+        CHECK(ERR_NONE == onward_vm_eval(&vm, "3 4 + 5", 5));
+        CHECK(1 == onward_vm_depth(&vm));
+        CHECK(7 == onward_vm_pop(&vm));
+        CHECK(asb == asp);
+    }
+
+    TEST(Verify_eval_compiles_words_into_the_instance_word_buffer)
+    {
+        onward_vm_t vm;
+        state_reset();
+        vm_reset(&vm);
+        char* source = ": sq dup * ; 6 sq";
+        CHECK(ERR_NONE == onward_vm_eval(&vm, source, strlen(source)));
+        CHECK(36 == onward_vm_pop(&vm));
+        CHECK((value_t)Word_Buf == vm.hbase);
+        CHECK(vm.here > vm.hbase);
+    }
+
+    TEST(Verify_eval_stops_and_reports_unknown_words)
+    {
+        onward_vm_t vm;
+        char output[64] = {0};
+        state_reset();
+        vm_reset(&vm);
+        onward_vm_output(&vm, output, sizeof(output));
+        char* source = "1 bogus 2";
+        CHECK(ERR_UNKNOWN_WORD == onward_vm_eval(&vm, source, strlen(source)));
+        CHECK(1 == onward_vm_depth(&vm));
+        CHECK(0 == strcmp(output, "Unknown word: bogus\n"));
+    }
+
+    TEST(Verify_eval_writes_emitted_characters_to_the_output_buffer)
+    {
+        onward_vm_t vm;
+        char output[4] = {0};
+        state_reset();
+        vm_reset(&vm);
+        onward_vm_output(&vm, output, 2);
+        char* source = "65 emit 66 emit 67 emit";
+        CHECK(ERR_NONE == onward_vm_eval(&vm, source, strlen(source)));
+        CHECK(0 == strcmp(output, "AB"));
+    }
+
+    TEST(Verify_eval_writes_to_emit_char_once_the_output_buffer_is_removed)
+    {
+        onward_vm_t vm;
+        char output[4] = {0};
+        state_reset();
+        vm_reset(&vm);
+        onward_vm_output(&vm, output, sizeof(output));
+        char* source = "65 emit";
+        CHECK(ERR_NONE == onward_vm_eval(&vm, source, strlen(source)));
+        onward_vm_output(&vm, NULL, 0);
+        source = "66 emit";
+        CHECK(ERR_NONE == onward_vm_eval(&vm, source, strlen(source)));
+        CHECK(0 == strcmp(output, "A"));
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: onward_vm_call
+    //-------------------------------------------------------------------------
+    TEST(Verify_call_executes_a_word_found_by_name_with_arguments)
+    {
+        onward_vm_t vm;
+        state_reset();
+        vm_reset(&vm);
+        word_t const* word = onward_vm_find(&vm, "-");
+        CHECK(&sub == word);
+        onward_vm_push(&vm, 10);
+        onward_vm_push(&vm, 3);
+        CHECK(ERR_NONE == onward_vm_call(&vm, word));
+        CHECK(7 == onward_vm_pop(&vm));
+        CHECK(0 == onward_vm_depth(&vm));
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: onward_vm_limit
+    //-------------------------------------------------------------------------
+    TEST(Verify_limits_stop_a_runaway_loop_and_are_reset_for_each_evaluation)
+    {
+        onward_vm_t vm;
+        char* spin = ": spin br [ 0 CELLSZ - , ] ; spin";
+        char* call = ": sq dup * ; 3 sq";
+        state_reset();
+        vm_reset(&vm);
+        onward_vm_limit(&vm, 1000, 0, 0);
+        CHECK(ERR_OUT_OF_FUEL == onward_vm_eval(&vm, spin, strlen(spin)));
+        CHECK(ERR_NONE == onward_vm_eval(&vm, call, strlen(call)));
+        CHECK(9 == onward_vm_pop(&vm));
+        onward_vm_limit(&vm, 0, 1000000, 0);
+        CHECK(ERR_DEADLINE == onward_vm_eval(&vm, spin, strlen(spin)));
+        CHECK(-1 == vm.fuel);
+    }
+
+    TEST(Verify_limits_stop_definitions_past_the_quota)
+    {
+        onward_vm_t vm;
+        char* source = ": sum 1 2 3 4 5 6 7 8 + + + + + + + ;";
+        state_reset();
+        vm_reset(&vm);
+        onward_vm_limit(&vm, 0, 0, 64);
+        CHECK(ERR_DICT_FULL == onward_vm_eval(&vm, source, strlen(source)));
+        CHECK(vm.here <= vm.hlimit);
+        onward_vm_limit(&vm, 0, 0, 0);
+        CHECK(ERR_NONE == onward_vm_eval(&vm, source, strlen(source)));
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: onward_xt_resolve
+    //-------------------------------------------------------------------------
+    TEST(Verify_resolve_caches_the_word_until_the_name_is_redefined)
+    {
+        onward_xt_t xt;
+        state_reset();
+        onward_xt_init(&xt, "dup");
+        CHECK(&_dup == onward_xt_resolve(&xt));
+        xt.word = &swap;
+        CHECK(&swap == onward_xt_resolve(&xt));
+        onward_aspush((value_t)"dup");
+        ((primitive_t)create.code)();
+        CHECK((word_t*)latest == onward_xt_resolve(&xt));
+    }
+
+    TEST(Verify_resolve_retries_a_missing_word_once_it_is_defined)
+    {
+        onward_xt_t xt;
+        state_reset();
+        onward_xt_init(&xt, "missing");
+        CHECK(NULL == onward_xt_resolve(&xt));
+        onward_aspush((value_t)"missing");
+        ((primitive_t)create.code)();
+        CHECK((word_t*)latest == onward_xt_resolve(&xt));
+    }
+
+    TEST(Verify_resolve_finds_the_word_of_each_instance)
+    {
+        onward_vm_t vm, other;
+        onward_xt_t xt;
+        word_t const* word;
+        state_reset();
+        vm_reset(&vm);
+        vm_reset_other(&other);
+        CHECK(ERR_NONE == onward_vm_eval(&vm, ": sq dup * ;", 12));
+        CHECK(ERR_NONE == onward_vm_eval(&other, ": sq dup dup * * ;", 18));
+        onward_xt_init(&xt, "sq");
+        word = onward_vm_resolve(&vm, &xt);
+        CHECK(onward_vm_find(&vm, "sq") == word);
+        CHECK(onward_vm_find(&other, "sq") == onward_vm_resolve(&other, &xt));
+        CHECK(word != onward_vm_resolve(&other, &xt));
+        CHECK(word == onward_vm_resolve(&vm, &xt));
+    }
+
+    TEST(Verify_hexec_executes_the_word_referenced_by_a_handle)
+    {
+        state_reset();
+        onward_aspush(2);
+        onward_aspush(3);
+        onward_aspush((value_t)"+");
+        ((primitive_t)handle.code)();
+        onward_xt_t* xt = (onward_xt_t*)onward_aspeek(0);
+        CHECK(0 == strcmp(xt->name, "+"));
+        CHECK(here > (value_t)xt);
+        ((primitive_t)hexec.code)();
+        CHECK(5 == onward_aspop());
+        CHECK(asb == asp);
+    }
+
+    //-------------------------------------------------------------------------
+    // Testing: evaluate
+    //-------------------------------------------------------------------------
+    TEST(Verify_evaluate_interprets_a_string_from_the_stack)
+    {
+        state_reset();
+        char* source = "2 3 *";
+        onward_aspush((value_t)source);
+        onward_aspush((value_t)strlen(source));
+        ((primitive_t)evaluate.code)();
+        CHECK(6 == onward_aspop());
+        CHECK(asb == asp);
+    }
+}